@@ -0,0 +1,128 @@
+#!/bin/sh
+#
+# NAME
+#	bench.sh
+#
+# PURPOSE
+#	Time McBOOLE on the function families of genpla, to follow the
+#	performance of the program from one version to the next.
+#
+# SYNOPSIS
+#	bench.sh [family arguments ...]
+#
+# DESCRIPTION
+#	Each function of the suite is generated by genpla and minimized
+#	REPS times (3 by default) with the -stats option. One CSV line is
+#	printed per function with the version of the program, the family
+#	and its arguments, the number of prime implicants, the number of
+#	cubes in the solution and the median over the repetitions of the
+#	wall clock time of each phase and of the whole run, in
+#	milliseconds. A phase not done is given as 0.
+#
+#	Without argument the suite below is used; otherwise the arguments
+#	are one function given as to genpla. OPTIONS holds more switches
+#	for McBOOLE, for instance OPTIONS="-eng zdd".
+#
+#	RULES lists branching rules, for instance RULES="affect minterm
+#	constrained cost random"; each function is then minimized with
+#	-branch and each rule in turn, the rule being given in the rule
+#	column, and the winning rule of each function, the one giving the
+#	fewest cubes then the shortest time, is printed on stderr at the
+#	end with the number of functions won by each rule. Without RULES
+#	the rule column is -.
+#
+
+MCBOOLE=${MCBOOLE:-./mcboole.exe}
+GENPLA=${GENPLA:-./genpla.exe}
+REPS=${REPS:-3}
+VERSION=${VERSION:-`git describe --always --dirty 2>/dev/null || echo unknown`}
+TMP=${TMPDIR:-/tmp}/bench.$$
+PHASES="read prime epi branch sparse write split"
+
+SUITE="adder 4
+adder 5
+mult 3
+mult 4
+parity 8
+parity 10
+comp 4
+comp 6
+cyclic 6
+cyclic 9
+random 12 4 150 0.3 0.1 1
+random 14 3 300 0.1 0.1 3
+random 16 8 200 0.4 0.2 5"
+
+[ $# -gt 0 ] && SUITE="$*"
+
+# median prints the median of the numbers read, one per line
+
+median() {
+  sort -n | awk '{ v[NR] = $1 } END { if(NR) print v[int((NR + 1) / 2)]; else print 0 }'
+}
+
+# field prints a number of the JSON statistics, given its key
+
+field() {
+  sed -n "s/.*\"$1\": \([0-9][0-9]*\).*/\1/p" $2 | head -1
+}
+
+# phase_ns prints the wall clock time of a phase in the JSON statistics
+
+phase_ns() {
+  sed -n "s/.*\"$1\": { \"wall_ns\": \([0-9][0-9]*\).*/\1/p" $2
+}
+
+printf "version,function,rule,primes,cubes"
+for p in $PHASES; do printf ",%s_ms" $p; done
+echo ",total_ms"
+
+echo "$SUITE" | while read function; do
+  $GENPLA $function > $TMP.in || exit 1
+  for rule in ${RULES:--}; do
+    branch=
+    [ "$rule" != "-" ] && branch="-branch $rule"
+    rm -f $TMP.times
+    rep=0
+    while [ $rep -lt $REPS ]; do
+      start=`date +%s%N`
+      $MCBOOLE $OPTIONS $branch -stats $TMP.json $TMP.in $TMP.out \
+	> /dev/null 2>&1
+      end=`date +%s%N`
+      for p in $PHASES; do
+	echo "$p `phase_ns $p $TMP.json`" >> $TMP.times
+      done
+      echo "total `expr \( $end - $start \) / 1000`" >> $TMP.times
+      rep=`expr $rep + 1`
+    done
+    primes=`field primes $TMP.json`
+    cubes=`field solution $TMP.json`
+    printf "%s,%s,%s,%s,%s" "$VERSION" "$function" "$rule" "$primes" "$cubes"
+    for p in $PHASES; do
+      ns=`awk -v p=$p '$1 == p && $2 != "" { print $2 }' $TMP.times | median`
+      printf ",%s" `echo $ns | awk '{ printf "%.3f", $1 / 1e6 }'`
+    done
+    us=`awk '$1 == "total" { print $2 }' $TMP.times | median`
+    echo ",`echo $us | awk '{ printf "%.3f", $1 / 1e3 }'`"
+  done
+done | tee $TMP.csv
+
+# with several rules, the winner of each function and the wins of each
+# rule are printed on stderr
+
+if [ `echo ${RULES:--} | wc -w` -gt 1 ]; then
+  awk -F, '{
+	if(!($2 in best) || $5 < cubes[$2] ||
+	   ($5 == cubes[$2] && $NF < total[$2]))
+	 { best[$2] = $3; cubes[$2] = $5; total[$2] = $NF }
+	if(!($2 in seen)) { seen[$2] = 1; order[++n] = $2 }
+     }
+     END {
+	for(i = 1 ; i <= n ; i++)
+	 { printf "winner,%s,%s\n", order[i], best[order[i]]
+	   wins[best[order[i]]]++
+	 }
+	for(r in wins) printf "wins,%s,%d\n", r, wins[r]
+     }' $TMP.csv >&2
+fi
+rm -f $TMP.in $TMP.out $TMP.json $TMP.times $TMP.csv
@@ -0,0 +1,42 @@
+#!/bin/sh
+#
+# NAME
+#	engines.sh
+#
+# PURPOSE
+#	Compare the prime implicant generation engines of McBOOLE on the
+#	shipped examples and on any other suite of functions.
+#
+# SYNOPSIS
+#	engines.sh [file or directory ...]
+#
+# DESCRIPTION
+#	Each function is minimized with every engine and one line is printed
+#	with the file, the engine, the number of prime implicants, the number
+#	of cubes in the solution and the elapsed time in seconds. When no
+#	argument is given the files in ../examples are used; a directory
+#	given as argument stands for all the .in files it contains.
+#
+
+MCBOOLE=${MCBOOLE:-./mcboole.exe}
+ENGINES=${ENGINES:-"part cons zdd"}
+TMP=${TMPDIR:-/tmp}/engines.$$
+
+[ $# -eq 0 ] && set -- ../examples
+
+echo "file,engine,primes,cubes,seconds"
+for arg in "$@"; do
+  if [ -d "$arg" ]; then files=`ls "$arg"/*.in 2>/dev/null`; else files=$arg; fi
+  for f in $files; do
+    for e in $ENGINES; do
+      start=`date +%s%N`
+      $MCBOOLE -v -eng $e "$f" $TMP.out > $TMP.log 2>&1
+      end=`date +%s%N`
+      primes=`sed -n 's/.*The function has \([0-9]*\) prime.*/\1/p' $TMP.log`
+      cubes=`sed -n 's/.*The solution contains \([0-9]*\) nodes.*/\1/p' $TMP.log`
+      seconds=`echo "$start $end" | awk '{ printf "%.3f", ($2 - $1) / 1e9 }'`
+      echo "`basename $f`,$e,$primes,$cubes,$seconds"
+    done
+  done
+done
+rm -f $TMP.out $TMP.log
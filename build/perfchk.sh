@@ -0,0 +1,161 @@
+#!/bin/sh
+#
+# NAME
+#	perfchk.sh
+#
+# PURPOSE
+#	Check that a change of McBOOLE keeps the solutions minimum and does
+#	not slow the program down, on a fixed suite of functions.
+#
+# SYNOPSIS
+#	perfchk.sh [-update]
+#
+# DESCRIPTION
+#	Each function of the suite is generated by genpla and minimized
+#	REPS times (3 by default) with the -stats option. The solution is
+#	checked with verify against the function: two covers of the same
+#	cost may differ, so the outputs are not compared. The number of
+#	cubes of the solution and the median wall clock time of each phase
+#	and of the whole run are then compared with the baseline file
+#	BASELINE (perf.base).
+#
+#	The check fails when a solution is not equivalent to its function,
+#	when the number of cubes differs from the baseline, or when a time
+#	exceeds the baseline by more than TOLERANCE percent (25) and by
+#	more than FLOOR milliseconds (5), so that the noise on the short
+#	phases is ignored. One line is printed per function and the exit
+#	status is 1 when something failed.
+#
+#	The times depend on the machine; with -update the baseline is
+#	written again from the current program, after the solutions are
+#	verified, to be committed with the change that explains it.
+#
+
+MCBOOLE=${MCBOOLE:-./mcboole.exe}
+GENPLA=${GENPLA:-./genpla.exe}
+VERIFY=${VERIFY:-./verify.exe}
+BASELINE=${BASELINE:-./perf.base}
+REPS=${REPS:-3}
+TOLERANCE=${TOLERANCE:-25}
+FLOOR=${FLOOR:-5}
+TMP=${TMPDIR:-/tmp}/perfchk.$$
+PHASES="read prime epi branch sparse write split"
+
+SUITE="adder 4
+adder 5
+mult 3
+parity 10
+comp 6
+cyclic 6
+cyclic 9
+random 12 4 150 0.3 0.1 1
+random 14 3 300 0.1 0.1 3"
+
+UPDATE=0
+[ "$1" = "-update" ] && UPDATE=1
+
+# median prints the median of the numbers read, one per line
+
+median() {
+  sort -n | awk '{ v[NR] = $1 } END { if(NR) print v[int((NR + 1) / 2)]; else print 0 }'
+}
+
+# field prints a number of the JSON statistics, given its key
+
+field() {
+  sed -n "s/.*\"$1\": \([0-9][0-9]*\).*/\1/p" $2 | head -1
+}
+
+# phase_ns prints the wall clock time of a phase in the JSON statistics
+
+phase_ns() {
+  sed -n "s/.*\"$1\": { \"wall_ns\": \([0-9][0-9]*\).*/\1/p" $2
+}
+
+# measure minimizes a function REPS times and prints its CSV line:
+# function,cubes,read_ms,...,split_ms,total_ms
+
+measure() {
+  rm -f $TMP.times
+  rep=0
+  while [ $rep -lt $REPS ]; do
+    start=`date +%s%N`
+    $MCBOOLE -stats $TMP.json $TMP.in $TMP.out > /dev/null 2>&1
+    end=`date +%s%N`
+    for p in $PHASES; do
+      echo "$p `phase_ns $p $TMP.json`" >> $TMP.times
+    done
+    echo "total `expr \( $end - $start \) / 1000`" >> $TMP.times
+    rep=`expr $rep + 1`
+  done
+  printf "%s,%s" "$1" "`field solution $TMP.json`"
+  for p in $PHASES; do
+    ns=`awk -v p=$p '$1 == p && $2 != "" { print $2 }' $TMP.times | median`
+    printf ",%s" `echo $ns | awk '{ printf "%.3f", $1 / 1e6 }'`
+  done
+  us=`awk '$1 == "total" { print $2 }' $TMP.times | median`
+  echo ",`echo $us | awk '{ printf "%.3f", $1 / 1e3 }'`"
+}
+
+# compare prints the differences between a line of the baseline and the
+# current one, nothing when they agree
+
+compare() {
+  echo "$1
+$2" | awk -F, -v tol=$TOLERANCE -v floor=$FLOOR -v phases="$PHASES total" '
+    NR == 1 { split($0, base, ","); next }
+    { n = split(phases, name, " "); sep = " "
+      if($2 != base[2]) { printf "%scubes %s, baseline %s", sep, $2, base[2]; sep = "; " }
+      for(i = 1; i <= n; i++) {
+        b = base[i + 2]; c = $(i + 2)
+        if(c > b * (1 + tol / 100) && c - b > floor)
+          { printf "%s%s %.1fms, baseline %.1fms", sep, name[i], c, b; sep = "; " }
+      }
+    }'
+}
+
+[ $UPDATE = 0 ] && [ ! -f $BASELINE ] && {
+  echo "$BASELINE missing, run perfchk.sh -update first"
+  exit 1
+}
+
+fail=0
+[ $UPDATE = 1 ] && {
+  printf "function,cubes" > $TMP.base
+  for p in $PHASES; do printf ",%s_ms" $p >> $TMP.base; done
+  echo ",total_ms" >> $TMP.base
+}
+
+echo "$SUITE" > $TMP.suite
+while read function; do
+  $GENPLA $function > $TMP.in || exit 1
+  line=`measure "$function"`
+  if $VERIFY $TMP.in $TMP.out > $TMP.verify 2>&1; then :; else
+    echo "FAIL $function: the solution is not equivalent to the function"
+    grep -v "McBOOLE" $TMP.verify | head -10
+    fail=1
+    continue
+  fi
+  if [ $UPDATE = 1 ]; then
+    echo "$line" >> $TMP.base
+    echo "base $line"
+    continue
+  fi
+  base=`grep "^$function," $BASELINE`
+  if [ -z "$base" ]; then
+    echo "FAIL $function: not in $BASELINE"
+    fail=1
+    continue
+  fi
+  diff=`compare "$base" "$line"`
+  if [ -n "$diff" ]; then
+    echo "FAIL $function:$diff"
+    fail=1
+  else
+    echo "ok   $line"
+  fi
+done < $TMP.suite
+
+[ $UPDATE = 1 ] && [ $fail = 0 ] && cp $TMP.base $BASELINE
+rm -f $TMP.in $TMP.out $TMP.json $TMP.times $TMP.verify $TMP.suite $TMP.base
+exit $fail
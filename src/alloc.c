@@ -5,6 +5,8 @@ NAME
  	alloc_cube_list, free_cube_list, flush_cube_list, free_list_of_cubes
 	alloc_binary, free_binary, flush_binary
 	alloc_parent, free_parent, flush_parent, free_list_of_parents
+	report_alloc_stats, foutput_alloc_stats, alloc_bytes_reserved
+	charge_memory, release_memory
 
 PURPOSE
 	because the system allocation routines are not efficient when
@@ -51,6 +53,20 @@ SYNOPSIS
 	free_list_of_parents(list)
 	struct parent **list;
 
+	report_alloc_stats(where)
+	char *where;
+
+	foutput_alloc_stats(file)
+	FILE *file;
+
+	long alloc_bytes_reserved()
+
+	charge_memory(bytes)
+	long bytes;
+
+	release_memory(bytes)
+	long bytes;
+
 DESCRIPTION
 	Big blocks of memory are allocated from which several nodes can be
 	made. Each time alloc node is called a piece of this block is passed;
@@ -64,10 +80,30 @@ DESCRIPTION
 	that apply  for the structure node will apply most of the time as well
 	for the structures parent,binary and cube_list. 
 
+	For each of the four pools the peak number of live structures, the
+	total number of allocations and the number of blocks are kept.
+	report_alloc_stats sends to the user, for each pool, these counts
+	with the live count, the length of the free list, and the bytes
+	reserved in blocks versus the bytes in use by live structures; the
+	title where tells at which point of the program they are taken.
+	foutput_alloc_stats writes the same figures to a file as a JSON
+	object and alloc_bytes_reserved returns the bytes reserved in all
+	the pools.
+
+	When a memory budget is given with -mem, the bytes reserved in the
+	blocks of the pools, and the bytes of the other big vectors given
+	to charge_memory and back to release_memory, are compared with it
+	each time they grow. When the budget is exceeded, memory_exceeded
+	is set for the solver to stop branching and, if memory_escape was
+	set by the prime implicant generation, a longjmp is done to it so
+	that a heuristic is used instead. The allocation goes on past the
+	budget otherwise: the budget is soft.
+
 DIAGNOSTIC
 	Each time we allocate space the code returned by the system is
 	verified and an error is signaled when no more memory is
-	available.
+	available; the statistics of the pools are then printed first to
+	tell which structure exhausted the memory.
 
 COORDINATES
 	McGill University Electrical Engineering MONTREAL CANADA
@@ -97,6 +133,38 @@ int
 	nb_alloc_binary =  0,
 	nb_alloc_nodes = 0;
 
+/* index of each pool in the statistics */
+
+#define POOL_NODE 0
+#define POOL_CUBE 1
+#define POOL_BINARY 2
+#define POOL_PARENT 3
+#define NB_POOLS 4
+
+struct pool_stats
+ { long peak;			/* highest number of live structures */
+   long total;			/* number of allocations since the start */
+   long blocks;			/* number of blocks allocated */
+ };
+
+static struct pool_stats pool_stats[NB_POOLS];
+
+static char *pool_name[NB_POOLS] = { "node", "cube_list", "binary", "parent" };
+
+/* NEW_LIVE counts an allocation in a pool and updates its peak */
+
+#define NEW_LIVE(pool,live) \
+	{ pool_stats[pool].total++; \
+	  if((live) > pool_stats[pool].peak) pool_stats[pool].peak = (live); }
+
+static alloc_failure(), check_budget();
+
+int memory_exceeded = 0;	/* MEMORY_OVER and MEMORY_CUT when reached */
+
+jmp_buf *memory_escape = NULL;	/* where to go when the budget is reached */
+
+static long charged = 0;	/* bytes charged outside the pools */
+
 struct block 
  { struct block *next_block;	/* pointer to next block allocated */
    char space[1];		/* the real size > 1 will be computed later */
@@ -146,12 +214,14 @@ struct node *alloc_node()
     and sending their address to the calling program.			*/
 
    nb_alloc_nodes++;
+   NEW_LIVE(POOL_NODE,nb_alloc_nodes);
    if(node_free_list != NULL)
     { temp_node = node_free_list;
       node_free_list = node_free_list->next_node;
       temp_node->next_node = NULL;
       temp_node->ancestors = NULL;
       temp_node->descendants = NULL;
+      temp_node->uncovered = NULL;
       temp_node->status = 0;
       return(temp_node);
     }
@@ -170,14 +240,21 @@ struct node *alloc_node()
     initialize the pointers in it and send one node out of it for now.
 									*/
 
-   temp_block = node_block_list;
-   node_block_list = (struct block *)
+/*  The block is linked in the list before the budget is checked, so that
+    it is flushed with the others when check_budget or alloc_failure
+    escape by longjmp.							*/
+
+   temp_block = (struct block *)
 		calloc(1,sizeof(struct block) + MANY_NODE * node_size);
-   if(node_block_list == NULL)fatal_system_error("unable to alloc nodes");
-   node_block_list->next_block = temp_block;
-   temp_node = (struct node *)node_block_list->space;
-   start_node_free = node_block_list->space + node_size;
+   if(temp_block == NULL)alloc_failure("unable to alloc nodes");
+   temp_block->next_block = node_block_list;
+   node_block_list = temp_block;
+   pool_stats[POOL_NODE].blocks++;
+   start_node_free = node_block_list->space;
    end_node_free = node_block_list->space + MANY_NODE * node_size;
+   if(memory_limit > 0) check_budget();
+   temp_node = (struct node *)start_node_free;
+   start_node_free = start_node_free + node_size;
    return(temp_node);
 }
 
@@ -209,6 +286,7 @@ flush_node()
 /*  All the blocks allocated to contain nodes are freed one by one */
 
    nb_alloc_nodes = 0;
+   pool_stats[POOL_NODE].blocks = 0;
    for(; node_block_list != NULL ; node_block_list = temp_block)
     { temp_block = node_block_list->next_block;
       free((char *)node_block_list);
@@ -253,6 +331,7 @@ struct cube_list *alloc_cube_list()
     section.								*/
 
    nb_alloc_cube_list++;
+   NEW_LIVE(POOL_CUBE,nb_alloc_cube_list);
    if(cube_free_list != NULL)
     { temp_cube = cube_free_list;
       cube_free_list = cube_free_list->next_cube;
@@ -266,14 +345,17 @@ struct cube_list *alloc_cube_list()
       return(temp_cube);
     }
 
-   temp_block = cube_block_list;
-   cube_block_list = (struct block *)
+   temp_block = (struct block *)
 		calloc(1,sizeof(struct block) + MANY_CUBE * cube_list_size);
-   if(cube_block_list == NULL)fatal_system_error("unable to alloc cubes");
-   cube_block_list->next_block = temp_block;
-   temp_cube = (struct cube_list *)cube_block_list->space;
-   start_cube_free = cube_block_list->space + cube_list_size;
+   if(temp_block == NULL)alloc_failure("unable to alloc cubes");
+   temp_block->next_block = cube_block_list;
+   cube_block_list = temp_block;
+   pool_stats[POOL_CUBE].blocks++;
+   start_cube_free = cube_block_list->space;
    end_cube_free = cube_block_list->space + MANY_CUBE * cube_list_size;
+   if(memory_limit > 0) check_budget();
+   temp_cube = (struct cube_list *)start_cube_free;
+   start_cube_free = start_cube_free + cube_list_size;
    return(temp_cube);
 }
 
@@ -296,6 +378,7 @@ flush_cube_list()
 
 {
    nb_alloc_cube_list = 0;
+   pool_stats[POOL_CUBE].blocks = 0;
    for(; cube_block_list != NULL ; cube_block_list = temp_block)
     { temp_block = cube_block_list->next_block;
       free((char *)cube_block_list);
@@ -335,6 +418,7 @@ struct binary *alloc_binary()
     section.								*/
 
    nb_alloc_binary++;
+   NEW_LIVE(POOL_BINARY,nb_alloc_binary);
    if(binary_free_list != NULL)
     { temp_binary = binary_free_list;
       binary_free_list = binary_free_list->is0._.subtree;
@@ -350,15 +434,18 @@ struct binary *alloc_binary()
       return(temp_binary);
     }
 
-   temp_block = binary_block_list;
-   binary_block_list = (struct block *)
+   temp_block = (struct block *)
     calloc(1,sizeof(struct block) + MANY_BINARY * sizeof(struct binary));
-   if(binary_block_list == NULL)fatal_user_error("unable to alloc binarys");
-   binary_block_list->next_block = temp_block;
-   temp_binary = (struct binary *)binary_block_list->space;
-   start_binary_free = binary_block_list->space + sizeof(struct binary);
+   if(temp_block == NULL)alloc_failure("unable to alloc binarys");
+   temp_block->next_block = binary_block_list;
+   binary_block_list = temp_block;
+   pool_stats[POOL_BINARY].blocks++;
+   start_binary_free = binary_block_list->space;
    end_binary_free = binary_block_list->space 
 				+ MANY_BINARY * sizeof(struct binary);
+   if(memory_limit > 0) check_budget();
+   temp_binary = (struct binary *)start_binary_free;
+   start_binary_free = start_binary_free + sizeof(struct binary);
    return(temp_binary);
 }
 
@@ -382,6 +469,7 @@ flush_binary()
    for(; binary_block_list != NULL ; binary_block_list = temp_block)
     { temp_block = binary_block_list->next_block;
       free((char *)binary_block_list);
+      pool_stats[POOL_BINARY].blocks--;
     }
    binary_free_list = NULL;
    start_binary_free = NULL;
@@ -398,6 +486,7 @@ struct parent *alloc_parent()
     section.								*/
 
    nb_alloc_parent++;
+   NEW_LIVE(POOL_PARENT,nb_alloc_parent);
    if(parent_free_list != NULL)
     { temp_parent = parent_free_list;
       parent_free_list = parent_free_list->next_parent;
@@ -411,15 +500,18 @@ struct parent *alloc_parent()
       return(temp_parent);
     }
 
-   temp_block = parent_block_list;
-   parent_block_list = (struct block *)calloc(1,sizeof(struct block) 
+   temp_block = (struct block *)calloc(1,sizeof(struct block) 
 		                 + MANY_PARENT * sizeof(struct parent));
-   if(parent_block_list == NULL)fatal_system_error("unable to alloc parents");
-   parent_block_list->next_block = temp_block;
-   temp_parent = (struct parent *)parent_block_list->space;
-   start_parent_free = parent_block_list->space + sizeof(struct parent);
+   if(temp_block == NULL)alloc_failure("unable to alloc parents");
+   temp_block->next_block = parent_block_list;
+   parent_block_list = temp_block;
+   pool_stats[POOL_PARENT].blocks++;
+   start_parent_free = parent_block_list->space;
    end_parent_free = parent_block_list->space 
 					+ MANY_PARENT * sizeof(struct parent);
+   if(memory_limit > 0) check_budget();
+   temp_parent = (struct parent *)start_parent_free;
+   start_parent_free = start_parent_free + sizeof(struct parent);
    return(temp_parent);
 }
 
@@ -442,6 +534,7 @@ flush_parent()
 
 {
    nb_alloc_parent = 0;
+   pool_stats[POOL_PARENT].blocks = 0;
    for(; parent_block_list != NULL ; parent_block_list = temp_block)
     { temp_block = parent_block_list->next_block;
       free((char *)parent_block_list);
@@ -471,3 +564,202 @@ struct parent **list;
   *list = NULL;
 }
 
+
+/*************************************************************************/
+
+/* pool_size gives the size in bytes of the structures of a pool */
+
+static long pool_size(pool)
+
+int pool;
+{
+  switch(pool)
+   { case POOL_NODE : return((long)node_size);
+     case POOL_CUBE : return((long)cube_list_size);
+     case POOL_BINARY : return((long)sizeof(struct binary));
+   }
+  return((long)sizeof(struct parent));
+}
+
+/*************************************************************************/
+
+/* pool_reserved gives the bytes reserved in the blocks of a pool */
+
+static long pool_reserved(pool)
+
+int pool;
+{
+  static int many[NB_POOLS] = { MANY_NODE, MANY_CUBE, MANY_BINARY, MANY_PARENT };
+
+  return(pool_stats[pool].blocks *
+	 ((long)sizeof(struct block) + many[pool] * pool_size(pool)));
+}
+
+/*************************************************************************/
+
+/* pool_live gives the number of live structures of a pool and the length
+   of its free list.							*/
+
+static pool_live(pool,live,free_length)
+
+int pool;
+long *live,*free_length;
+{
+  struct node *node;
+  struct cube_list *cube;
+  struct binary *binary;
+  struct parent *parent;
+
+  *free_length = 0;
+  switch(pool)
+   { case POOL_NODE :
+	*live = nb_alloc_nodes;
+	for(node = node_free_list ; node != NULL ; node = node->next_node)
+	    (*free_length)++;
+	break;
+
+     case POOL_CUBE :
+	*live = nb_alloc_cube_list;
+	for(cube = cube_free_list ; cube != NULL ; cube = cube->next_cube)
+	    (*free_length)++;
+	break;
+
+     case POOL_BINARY :
+	*live = nb_alloc_binary;
+	for(binary = binary_free_list ; binary != NULL ;
+	    binary = binary->is0._.subtree)
+	    (*free_length)++;
+	break;
+
+     case POOL_PARENT :
+	*live = nb_alloc_parent;
+	for(parent = parent_free_list ; parent != NULL ;
+	    parent = parent->next_parent)
+	    (*free_length)++;
+	break;
+   }
+}
+
+/*************************************************************************/
+
+long alloc_bytes_reserved()
+
+{
+  long total;
+
+  int pool;
+
+  total = 0;
+  for(pool = 0 ; pool < NB_POOLS ; pool++) total += pool_reserved(pool);
+  return(total);
+}
+
+/*************************************************************************/
+
+report_alloc_stats(where)
+
+char *where;
+{
+  long live,free_length;
+
+  int pool;
+
+  sprintf(error_buffer,"allocation at %s : %ld bytes reserved",where,
+	  alloc_bytes_reserved());
+  send_user_message(error_buffer);
+  for(pool = 0 ; pool < NB_POOLS ; pool++)
+   { pool_live(pool,&live,&free_length);
+     sprintf(error_buffer,
+	"  %-9s live %ld peak %ld total %ld blocks %ld free %ld bytes %ld/%ld",
+	pool_name[pool],live,pool_stats[pool].peak,pool_stats[pool].total,
+	pool_stats[pool].blocks,free_length,live * pool_size(pool),
+	pool_reserved(pool));
+     send_user_message(error_buffer);
+   }
+}
+
+/*************************************************************************/
+
+foutput_alloc_stats(file)
+
+FILE *file;
+{
+  long live,free_length;
+
+  int pool;
+
+  fprintf(file,"{");
+  for(pool = 0 ; pool < NB_POOLS ; pool++)
+   { pool_live(pool,&live,&free_length);
+     fprintf(file,"%s\n    \"%s\": { \"live\": %ld, \"peak\": %ld, ",
+	     pool ? "," : "",pool_name[pool],live,pool_stats[pool].peak);
+     fprintf(file,"\"total\": %ld, \"blocks\": %ld, \"free_list\": %ld, ",
+	     pool_stats[pool].total,pool_stats[pool].blocks,free_length);
+     fprintf(file,"\"bytes_in_use\": %ld, \"bytes_reserved\": %ld }",
+	     live * pool_size(pool),pool_reserved(pool));
+   }
+  fprintf(file,"\n  }");
+}
+
+/*************************************************************************/
+
+/* alloc_failure reports the pools before stopping when the system refuses
+   a new block, to tell which structure exhausted the memory.		*/
+
+static alloc_failure(message)
+
+char *message;
+{
+  jmp_buf *escape;
+
+  if(memory_escape != NULL)
+   { escape = memory_escape;
+     memory_escape = NULL;
+     memory_exceeded |= MEMORY_OVER;
+     longjmp(*escape,1);
+   }
+  report_alloc_stats("failure");
+  fatal_system_error(message);
+}
+
+/*************************************************************************/
+
+/* check_budget compares the memory used with the budget */
+
+static check_budget()
+
+{
+  jmp_buf *escape;
+
+  if(alloc_bytes_reserved() + charged <= memory_limit * 1048576L) return;
+  if((memory_exceeded & MEMORY_OVER) == 0 && VERBOSIS)
+   { sprintf(error_buffer,"memory budget of %d Mbytes reached",memory_limit);
+     send_user_message(error_buffer);
+     report_alloc_stats("budget");
+   }
+  memory_exceeded |= MEMORY_OVER;
+  if(memory_escape != NULL)
+   { escape = memory_escape;
+     memory_escape = NULL;
+     longjmp(*escape,1);
+   }
+}
+
+/*************************************************************************/
+
+charge_memory(bytes)
+
+long bytes;
+{
+  charged += bytes;
+  if(memory_limit > 0) check_budget();
+}
+
+/*************************************************************************/
+
+release_memory(bytes)
+
+long bytes;
+{
+  charged -= bytes;
+}
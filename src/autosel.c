@@ -0,0 +1,551 @@
+/*********************************************************************
+
+NAME
+	generate_prime_implicants, select_prime_engine, time_prime_engines,
+	time_branch_rules
+
+PURPOSE
+	Several engines can generate the prime implicants and none is the
+	fastest on all the functions. These functions call the engine
+	asked for by the user or pick one from a few statistics on the
+	cubes read, using the timings of a benchmark run.
+
+SYNOPSIS
+	struct node *generate_prime_implicants(engine,list)
+	char *engine;
+	struct node *list;
+
+	char *select_prime_engine(list)
+	struct node *list;
+
+	char *time_prime_engines(list)
+	struct node *list;
+
+	int time_branch_rules(list)
+	struct node *list;
+
+DESCRIPTION
+    -generate_prime_implicants calls the engine named by the string
+	engine on the list of cubes and returns the list of prime
+	implicants linked in a graph. The engine auto selects the engine
+	with select_prime_engine and the engine time with
+	time_prime_engines.
+
+	When a memory budget is given with -mem and it is reached while
+	the engine runs, the allocation returns here by longjmp and the
+	implicants are found by prime_implicants_by_expansion on a copy of
+	the list kept before, once the tables left by the engine are freed;
+	once the budget is reached the expansion is used directly. The
+	global prime_graph tells whether the graph returned holds all the
+	prime implicants, PRIME_ALL, and whether every pair of intersecting
+	nodes is linked, PRIME_LINKED, as -load-primes with a delta needs.
+
+    -select_prime_engine computes the statistics of the list: number of
+	cubes, of inputs and of outputs, density of dont care at output,
+	density of x at input and the balance between the 0 and 1 of each
+	input, as select_input examines them. The sample nearest to these
+	statistics in the benchmark table, and in the calibration file
+	when one is given with -calib, tells which engine was the fastest
+	and this engine is returned.
+
+    -time_prime_engines runs each engine, followed by the covering, in a
+	child process on the list of cubes and measures the elapsed time.
+	The statistics of the list and the fastest engine are appended to
+	the calibration file, if any, and the fastest engine is returned.
+	Running it on a suite of functions builds a calibration file.
+
+	The built in table holds 61 samples, timed as time_prime_engines
+	does on random functions of genpla with 50, 200 and 800 cubes, 8,
+	14 and 20 inputs, 2 and 16 outputs, an x density of 0.2 and 0.5
+	and a dont care ratio of 0 and 0.3; the functions where no engine
+	finished in 10 seconds are left out. When the nearest sample is
+	farther than MAX_DISTANCE, the function is unlike all of them and
+	part, the fastest on most samples, is returned.
+
+    -time_branch_rules runs the covering of the prime implicants with
+	each branching rule of select_node in a child process, which
+	sends back the number of cubes and of literals at input of its
+	solution and its branching depth, or limit when the depth limit
+	was reached. Each rule and its result are
+	written in the output file, and the number of the rule giving the
+	fewest cubes, then the fewest literals, then the shortest time,
+	is returned. It is called by find_best_covering with -branch time.
+
+*********************************************************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "cubes.h"
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+
+#define NB_FEATURES 6		/* statistics describing a function */
+#define MAX_SAMPLES 1024	/* samples kept from the calibration file */
+#define MAX_DISTANCE 2.5	/* distance beyond which no sample is near */
+
+struct engine_entry
+ { char *name;			/* name given with -eng */
+   struct node *(*generate)();	/* function generating the primes */
+   int (*cleanup)();		/* frees what the engine left when stopped */
+   int graph;			/* PRIME_ALL and PRIME_LINKED for its graph */
+ };
+
+struct engine_sample
+ { float feature[NB_FEATURES];	/* statistics of the function */
+   char engine[8];		/* fastest engine for this function */
+ };
+
+static struct engine_entry engine_table[] =
+ { { "part", prime_implicants_by_recursive_partitioning, flush_binary,
+     PRIME_ALL },
+   { "cons", prime_implicants_by_consensus, NULL, PRIME_ALL | PRIME_LINKED },
+   { "zdd", prime_implicants_by_zdd, zdd_cleanup, PRIME_LINKED }
+ };
+
+int prime_graph = 0;		/* PRIME_ALL and PRIME_LINKED, last engine */
+
+#define NB_ENGINES (sizeof(engine_table) / sizeof(struct engine_entry))
+
+/* cubes inputs outputs dont-care x balance : fastest engine, part when
+   it was within 10 percent and a millisecond of the fastest		*/
+
+static struct engine_sample builtin_samples[] =
+ {
+   { { 50, 8, 2, 0.000, 0.200, 0.550 }, "part" },
+   { { 50, 8, 2, 0.475, 0.203, 0.561 }, "part" },
+   { { 50, 8, 2, 0.000, 0.537, 0.602 }, "part" },
+   { { 50, 8, 2, 0.351, 0.472, 0.585 }, "part" },
+   { { 50, 8, 16, 0.000, 0.198, 0.551 }, "part" },
+   { { 50, 8, 16, 0.444, 0.155, 0.541 }, "part" },
+   { { 50, 8, 16, 0.000, 0.502, 0.612 }, "part" },
+   { { 50, 8, 16, 0.477, 0.492, 0.620 }, "part" },
+   { { 50, 14, 2, 0.000, 0.194, 0.550 }, "part" },
+   { { 50, 14, 2, 0.373, 0.227, 0.593 }, "part" },
+   { { 50, 14, 2, 0.000, 0.516, 0.593 }, "part" },
+   { { 50, 14, 2, 0.500, 0.524, 0.573 }, "part" },
+   { { 50, 14, 16, 0.000, 0.206, 0.566 }, "part" },
+   { { 50, 14, 16, 0.500, 0.223, 0.561 }, "part" },
+   { { 50, 14, 16, 0.000, 0.509, 0.585 }, "zdd" },
+   { { 50, 14, 16, 0.479, 0.521, 0.595 }, "zdd" },
+   { { 50, 20, 2, 0.000, 0.183, 0.571 }, "part" },
+   { { 50, 20, 2, 0.410, 0.203, 0.572 }, "part" },
+   { { 50, 20, 2, 0.000, 0.508, 0.569 }, "part" },
+   { { 50, 20, 2, 0.493, 0.492, 0.607 }, "cons" },
+   { { 50, 20, 16, 0.000, 0.192, 0.575 }, "part" },
+   { { 50, 20, 16, 0.481, 0.189, 0.553 }, "part" },
+   { { 50, 20, 16, 0.000, 0.489, 0.585 }, "part" },
+   { { 50, 20, 16, 0.453, 0.490, 0.585 }, "part" },
+   { { 200, 8, 2, 0.000, 0.199, 0.551 }, "part" },
+   { { 200, 8, 2, 0.375, 0.205, 0.527 }, "part" },
+   { { 200, 8, 2, 0.000, 0.487, 0.535 }, "part" },
+   { { 200, 8, 2, 0.427, 0.512, 0.572 }, "part" },
+   { { 200, 8, 16, 0.000, 0.198, 0.520 }, "part" },
+   { { 200, 8, 16, 0.450, 0.219, 0.533 }, "part" },
+   { { 200, 8, 16, 0.000, 0.499, 0.528 }, "part" },
+   { { 200, 8, 16, 0.466, 0.482, 0.539 }, "part" },
+   { { 200, 14, 2, 0.000, 0.203, 0.532 }, "part" },
+   { { 200, 14, 2, 0.405, 0.192, 0.533 }, "part" },
+   { { 200, 14, 16, 0.000, 0.214, 0.534 }, "part" },
+   { { 200, 14, 16, 0.465, 0.211, 0.534 }, "part" },
+   { { 200, 20, 2, 0.000, 0.208, 0.537 }, "part" },
+   { { 200, 20, 2, 0.370, 0.185, 0.529 }, "part" },
+   { { 200, 20, 2, 0.000, 0.502, 0.539 }, "zdd" },
+   { { 200, 20, 2, 0.389, 0.500, 0.535 }, "zdd" },
+   { { 200, 20, 16, 0.000, 0.191, 0.535 }, "part" },
+   { { 200, 20, 16, 0.454, 0.202, 0.523 }, "part" },
+   { { 800, 8, 2, 0.000, 0.203, 0.515 }, "part" },
+   { { 800, 8, 2, 0.393, 0.195, 0.514 }, "part" },
+   { { 800, 8, 2, 0.000, 0.509, 0.514 }, "cons" },
+   { { 800, 8, 2, 0.375, 0.503, 0.512 }, "part" },
+   { { 800, 8, 16, 0.000, 0.200, 0.516 }, "part" },
+   { { 800, 8, 16, 0.469, 0.206, 0.517 }, "part" },
+   { { 800, 8, 16, 0.000, 0.510, 0.519 }, "part" },
+   { { 800, 8, 16, 0.451, 0.503, 0.518 }, "part" },
+   { { 800, 14, 2, 0.000, 0.193, 0.512 }, "part" },
+   { { 800, 14, 2, 0.412, 0.199, 0.515 }, "part" },
+   { { 800, 14, 2, 0.000, 0.498, 0.522 }, "part" },
+   { { 800, 14, 2, 0.405, 0.500, 0.520 }, "zdd" },
+   { { 800, 14, 16, 0.000, 0.194, 0.514 }, "zdd" },
+   { { 800, 14, 16, 0.464, 0.195, 0.518 }, "part" },
+   { { 800, 14, 16, 0.457, 0.503, 0.523 }, "part" },
+   { { 800, 20, 2, 0.000, 0.195, 0.516 }, "part" },
+   { { 800, 20, 2, 0.399, 0.199, 0.516 }, "part" },
+   { { 800, 20, 16, 0.000, 0.199, 0.517 }, "part" },
+   { { 800, 20, 16, 0.466, 0.201, 0.514 }, "part" }
+ };
+
+#define NB_BUILTIN (sizeof(builtin_samples) / sizeof(struct engine_sample))
+
+static struct engine_sample calib_samples[MAX_SAMPLES];
+
+/***********************************************************************/
+
+/* function_statistics fills the vector feature with the statistics of a
+   list of cubes.							*/
+
+static function_statistics(list,feature)
+
+struct node *list;
+float *feature;
+{
+  struct node *temp_node;	/* node in the list */
+
+  long
+	nb0,nb1,nbx,		/* codes for the current input */
+	nb_cubes,		/* number of cubes in the list */
+	nb_x,			/* number of x at input */
+	nb_dc,			/* number of dont care at output */
+	nb_asserted;		/* number of 1 or dont care at output */
+
+  double balance;		/* sum of the balance of each input */
+
+  int i,code,balanced_inputs;
+
+  nb_cubes = 0;
+  nb_dc = 0;
+  nb_asserted = 0;
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { nb_cubes++;
+     for(i = 0 ; i < output_number ; i++)
+      { code = extract_var(temp_node->cube,input_length * var_per_word + i);
+	if(code == _X_) nb_dc++;
+	if(code & _1_) nb_asserted++;
+      }
+   }
+
+  nb_x = 0;
+  balance = 0.0;
+  balanced_inputs = 0;
+  for(i = 0 ; i < input_number ; i++)
+   { define_current_var(i);
+     nb0 = nb1 = nbx = 0;
+     for(temp_node = list ; temp_node != NULL ;
+	 temp_node = temp_node->next_node)
+      { switch(extract_current_var(temp_node->cube))
+	 { case _1_ : nb1++; break;
+	   case _0_ : nb0++; break;
+	   default : nbx++; break;
+	 }
+      }
+     nb_x += nbx;
+     if(nb0 + nb1 > 0)
+      { balance += (double)(nb0 > nb1 ? nb0 : nb1) / (double)(nb0 + nb1);
+	balanced_inputs++;
+      }
+   }
+
+  feature[0] = nb_cubes;
+  feature[1] = input_number;
+  feature[2] = output_number;
+  feature[3] = nb_asserted ? (float)nb_dc / nb_asserted : 0.0;
+  feature[4] = nb_cubes ? (float)nb_x / (nb_cubes * input_number) : 0.0;
+  feature[5] = balanced_inputs ? balance / balanced_inputs : 1.0;
+}
+
+/***********************************************************************/
+
+/* sample_distance returns the distance between two vectors of statistics;
+   the sizes are compared by their relative difference.		*/
+
+static double sample_distance(f1,f2)
+
+float *f1,*f2;
+{
+  double distance,delta;
+
+  int i;
+
+  distance = 0.0;
+  for(i = 0 ; i < 3 ; i++)
+   { delta = 2.0 * (f1[i] - f2[i]) / (f1[i] + f2[i] + 1.0);
+     distance += delta * delta;
+   }
+  for(; i < NB_FEATURES ; i++)
+   { delta = 4.0 * (f1[i] - f2[i]);
+     distance += delta * delta;
+   }
+  return(distance);
+}
+
+/***********************************************************************/
+
+/* read_calibration reads the samples of the calibration file; each line
+   contains the statistics followed by the fastest engine and, possibly,
+   by the times measured which are ignored.				*/
+
+static int read_calibration(file_name)
+
+char *file_name;
+{
+  FILE *file;
+
+  struct engine_sample *sample;
+
+  int nb_samples,c;
+
+  if(file_name[0] == '\0' || (file = fopen(file_name,"r")) == NULL) return(0);
+  nb_samples = 0;
+  while(nb_samples < MAX_SAMPLES)
+   { sample = calib_samples + nb_samples;
+     if(fscanf(file,"%f %f %f %f %f %f %7s",sample->feature,
+	sample->feature + 1,sample->feature + 2,sample->feature + 3,
+	sample->feature + 4,sample->feature + 5,sample->engine) != 7) break;
+     nb_samples++;
+     while((c = getc(file)) != EOF && c != '\n');
+   }
+  fclose(file);
+  return(nb_samples);
+}
+
+/***********************************************************************/
+
+struct node
+*generate_prime_implicants(engine,list)
+
+char *engine;
+struct node *list;
+{
+  struct node
+	*saved,		/* copy of the list kept for the heuristic */
+	**saved_end,	/* where the next copy goes */
+	*temp_node;	/* node copied */
+
+  jmp_buf escape;	/* where the allocation goes when over budget */
+
+  int i;
+
+  if(strcmp(engine,"auto") == 0) engine = select_prime_engine(list);
+  else if(strcmp(engine,"time") == 0) engine = time_prime_engines(list);
+
+  for(i = 0 ; i < NB_ENGINES ; i++)
+   { if(strcmp(engine,engine_table[i].name) == 0) break;
+   }
+  if(i == NB_ENGINES) fatal_user_error("unknown prime generation engine");
+  prime_graph = engine_table[i].graph;
+  if(memory_limit == 0) return((*engine_table[i].generate)(list));
+
+/* With a memory budget, a copy of the list is kept for the expansion
+   heuristic, which is used when the budget is reached by the engine or
+   was reached before.							*/
+
+  saved = NULL;
+  saved_end = &saved;
+  for(temp_node = list ; temp_node != NULL && memory_exceeded == 0 ;
+      temp_node = temp_node->next_node)
+   { *saved_end = copy_and_alloc_node(temp_node->cube);
+     saved_end = &(*saved_end)->next_node;
+   }
+  *saved_end = NULL;
+  if(memory_exceeded)
+   { free_list_of_nodes(&saved);
+     memory_exceeded |= MEMORY_CUT;
+     prime_graph = PRIME_LINKED;
+     return(prime_implicants_by_expansion(list));
+   }
+  if(setjmp(escape) != 0)
+   { memory_exceeded |= MEMORY_CUT;
+     prime_graph = PRIME_LINKED;
+     if(VERBOSIS)
+	send_user_message("prime implicants stopped by the memory budget");
+     if(engine_table[i].cleanup != NULL) (*engine_table[i].cleanup)();
+     return(prime_implicants_by_expansion(saved));
+   }
+  memory_escape = &escape;
+  list = (*engine_table[i].generate)(list);
+  memory_escape = NULL;
+  free_list_of_nodes(&saved);
+  return(list);
+}
+
+/***********************************************************************/
+
+char *select_prime_engine(list)
+
+struct node *list;
+{
+  struct engine_sample *best;	/* nearest sample */
+
+  float feature[NB_FEATURES];	/* statistics of the list */
+
+  double distance,best_distance;
+
+  int i,nb_calib;
+
+  function_statistics(list,feature);
+  nb_calib = read_calibration(calib_file);
+
+  best = builtin_samples;
+  best_distance = sample_distance(feature,best->feature);
+  for(i = 1 ; i < NB_BUILTIN + nb_calib ; i++)
+   { distance = sample_distance(feature, i < NB_BUILTIN ?
+	builtin_samples[i].feature : calib_samples[i - NB_BUILTIN].feature);
+     if(distance < best_distance)
+      { best_distance = distance;
+	best = i < NB_BUILTIN ? builtin_samples + i :
+			calib_samples + i - NB_BUILTIN;
+      }
+   }
+
+  if(best_distance > MAX_DISTANCE)
+   { if(VERBOSIS)
+      { sprintf(error_buffer,
+	   "auto engine : part, nearest sample at %.2f : %.0f cubes in %.0f out %.0f",
+	   best_distance,best->feature[0],best->feature[1],best->feature[2]);
+	send_user_message(error_buffer);
+      }
+     return("part");
+   }
+
+  if(VERBOSIS)
+   { sprintf(error_buffer,
+	"auto engine : %s, nearest of %d samples : %.0f cubes in %.0f out %.0f",
+	best->engine,(int)NB_BUILTIN + nb_calib,best->feature[0],
+	best->feature[1],best->feature[2]);
+     send_user_message(error_buffer);
+   }
+  return(best->engine);
+}
+
+/***********************************************************************/
+
+char *time_prime_engines(list)
+
+struct node *list;
+{
+  struct timeval start,end;	/* time before and after the child */
+
+  float feature[NB_FEATURES];	/* statistics of the list */
+
+  double elapsed[NB_ENGINES];	/* time taken by each engine */
+
+  FILE *file;			/* calibration file */
+
+  pid_t pid;
+
+  int i,best,status;
+
+  function_statistics(list,feature);
+  best = 0;
+  for(i = 0 ; i < NB_ENGINES ; i++)
+   { fflush(stdout);
+     fflush(stderr);
+     fflush(output_file);
+     gettimeofday(&start,NULL);
+     pid = fork();
+     if(pid < 0) fatal_system_error("unable to fork engine");
+
+/* the child runs the engine and the covering on its copy of the list,
+   quietly, and leaves without touching the files of the parent.     */
+
+     if(pid == 0)
+      { quiet_child(0);
+	branch_rule = branch_rules[branch_rule_number].name;
+	find_best_covering((*engine_table[i].generate)(list));
+	_exit(0);
+      }
+     (void)waitpid(pid,&status,0);
+     gettimeofday(&end,NULL);
+     elapsed[i] = (end.tv_sec - start.tv_sec) +
+		  (end.tv_usec - start.tv_usec) / 1e6;
+     if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) elapsed[i] = 1e30;
+     if(elapsed[i] < elapsed[best]) best = i;
+     if(VERBOSIS)
+      { sprintf(error_buffer,"time engine : %s %.3fs",
+		engine_table[i].name,elapsed[i]);
+	send_user_message(error_buffer);
+      }
+   }
+
+  if(calib_file[0] != '\0')
+   { if((file = fopen(calib_file,"a")) == NULL)
+	fatal_user_error("unable to open the calibration file");
+     fprintf(file,"%.0f %.0f %.0f %.3f %.3f %.3f %s",feature[0],feature[1],
+	feature[2],feature[3],feature[4],feature[5],engine_table[best].name);
+     for(i = 0 ; i < NB_ENGINES ; i++) fprintf(file," %.4f",elapsed[i]);
+     fprintf(file,"\n");
+     fclose(file);
+   }
+  return(engine_table[best].name);
+}
+
+/***********************************************************************/
+
+int time_branch_rules(list)
+
+struct node *list;
+{
+  struct timeval start,end;	/* time before and after the child */
+
+  struct node **cursor;		/* pointer in the solution of the child */
+
+  double elapsed,best_elapsed;	/* time taken by a rule and the best one */
+
+  int
+	result[3],		/* cubes, literals and depth of a solution */
+	best_result[3],		/* result of the best rule */
+	channel[2],		/* pipe from the child */
+	i,best,status;
+
+  pid_t pid;
+
+  best = -1;
+  best_elapsed = 0.0;
+  for(i = 0 ; i < nb_branch_rules ; i++)
+   { fflush(stdout);
+     fflush(stderr);
+     fflush(output_file);
+     if(pipe(channel) != 0) fatal_system_error("unable to open a pipe");
+     gettimeofday(&start,NULL);
+     pid = fork();
+     if(pid < 0) fatal_system_error("unable to fork branching rule");
+
+/* the child covers its copy of the prime implicants with the rule i,
+   quietly, and writes the size of its solution on the pipe.	     */
+
+     if(pid == 0)
+      { close(channel[0]);
+	quiet_child(0);
+	branch_rule = branch_rules[i].name;
+	branch_rule_number = i;
+	find_best_covering(list);
+	result[0] = retained_nodes - prime_nodes;
+	result[1] = 0;
+	for(cursor = prime_nodes ; cursor < retained_nodes ; cursor++)
+		result[1] += input_cost((*cursor)->cube);
+	result[2] = max_branching_depth;
+	_exit(write(channel[1],(char *)result,sizeof(result)) !=
+	      sizeof(result));
+      }
+     close(channel[1]);
+     if(read(channel[0],(char *)result,sizeof(result)) != sizeof(result))
+	result[0] = -1;
+     close(channel[0]);
+     (void)waitpid(pid,&status,0);
+     gettimeofday(&end,NULL);
+     elapsed = (end.tv_sec - start.tv_sec) +
+	       (end.tv_usec - start.tv_usec) / 1e6;
+     if(!WIFEXITED(status) || WEXITSTATUS(status) != 0 || result[0] < 0)
+      { warning_user_error("a branching rule failed");
+	continue;
+      }
+     if(result[2] >= INFINITY)
+	sprintf(error_buffer,"time branch : %s %d cubes %d literals limit %.3fs",
+		branch_rules[i].name,result[0],result[1],elapsed);
+     else sprintf(error_buffer,"time branch : %s %d cubes %d literals depth %d %.3fs",
+		  branch_rules[i].name,result[0],result[1],result[2],elapsed);
+     if(VERBOSIS)send_user_message(error_buffer);
+     send_file_dtime(error_buffer);
+     if(best < 0 || result[0] < best_result[0] ||
+	(result[0] == best_result[0] && (result[1] < best_result[1] ||
+	(result[1] == best_result[1] && elapsed < best_elapsed))))
+      { best = i;
+	best_elapsed = elapsed;
+	memcpy((char *)best_result,(char *)result,sizeof(result));
+      }
+   }
+  if(best < 0) fatal_system_error("no branching rule succeeded");
+  return(best);
+}
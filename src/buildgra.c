@@ -1,4 +1,5 @@
 #include "cubes.h"
+#include <stdlib.h>
 
 /************************************************************************
 
@@ -50,6 +51,7 @@ struct node **node0,**node1,*nodex;
    cover_status |= covers(nodex->cube,(*node1)->cube);
    temp_node0 = *node0;
    temp_node1 = *node1; 
+   COUNT(COUNT_MERGE_CASE + cover_status);
 
    switch(cover_status)
     { case 0 :
@@ -355,3 +357,299 @@ struct node *good_node,**bad_node;
   free_node(temp_node);
 }
 
+
+/****************************************************************************
+
+NAME
+	link_prime_list
+
+PURPOSE
+	When the prime implicants are not produced by the recursive
+	partitioning, they arrive as a flat list without any link. This
+	function builds the covering graph for such a list so that it can
+	be processed by find_best_covering like any other graph.
+
+SYNOPSIS
+	link_prime_list(list)
+	struct node *list;
+
+DESCRIPTION
+	Every pair of intersecting nodes is linked, the node earlier in the
+	list becoming the ancestor of the other one. The pairs are found by
+	partitioning the nodes along the input variables: two nodes with
+	a 0 and a 1 for the same input cannot intersect, so only the pairs
+	falling in the same side or having an x need to be compared. The
+	id field of the nodes holds their rank in the list during the
+	process and is reset to 0 at the end.
+
+	The same partitioning is offered by pair_within, which calls a
+	function on each pair of nodes of a vector that may intersect at
+	input, instead of linking them.
+
+	link_added_nodes(list,added) links the nodes of list from added to
+	its end, the other nodes being linked already: the pairs of added
+	nodes and the pairs of an added node and another node are compared,
+	with the same order of ancestors.
+
+***************************************************************************/
+
+#define LINK_SPLIT 16		/* below this size the nodes are compared */
+
+static struct node **link_vector;	/* all the nodes of the list */
+
+static int link_pair();
+
+static int (*pair_action)();	/* called on the pairs of nodes compared */
+
+link_prime_list(list)
+
+struct node *list;
+{
+  struct node *temp_node;	/* pointer in the list */
+
+  int nb_nodes;			/* number of nodes in the list */
+
+  nb_nodes = 0;
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { temp_node->id = nb_nodes;
+     nb_nodes++;
+   }
+  if(nb_nodes < 2) 
+   { if(list != NULL) list->id = 0;
+     return;
+   }
+
+  link_vector = (struct node **)
+		calloc((unsigned)nb_nodes,sizeof(struct node *));
+  if(link_vector == NULL)fatal_system_error("unable to alloc link vector");
+  nb_nodes = 0;
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { link_vector[nb_nodes++] = temp_node;
+   }
+
+  pair_action = link_pair;
+  link_within(link_vector,nb_nodes,0);
+
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { temp_node->id = 0;
+   }
+  free((char *)link_vector);
+}
+
+/****************************************************************************/
+
+link_added_nodes(list,added)
+
+struct node *list,*added;
+{
+  struct node *temp_node;	/* pointer in the list */
+
+  int
+	nb_old,			/* number of nodes before added */
+	nb_nodes;		/* number of nodes in the list */
+
+  nb_old = -1;
+  nb_nodes = 0;
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { if(temp_node == added) nb_old = nb_nodes;
+     temp_node->id = nb_nodes;
+     nb_nodes++;
+   }
+  if(nb_old < 0 || nb_nodes < 2)
+   { for(temp_node = list ; temp_node != NULL ;
+	 temp_node = temp_node->next_node) temp_node->id = 0;
+     return;
+   }
+
+  link_vector = (struct node **)
+		calloc((unsigned)nb_nodes,sizeof(struct node *));
+  if(link_vector == NULL)fatal_system_error("unable to alloc link vector");
+  nb_nodes = 0;
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { link_vector[nb_nodes++] = temp_node;
+   }
+
+  pair_action = link_pair;
+  link_within(link_vector + nb_old,nb_nodes - nb_old,0);
+  link_between(link_vector,nb_old,link_vector + nb_old,nb_nodes - nb_old,0);
+
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { temp_node->id = 0;
+   }
+  free((char *)link_vector);
+}
+
+/****************************************************************************/
+
+static link_pair(node1,node2)
+
+struct node *node1,*node2;
+{
+  struct node *temp_node;	/* node exchanged to respect the order */
+
+  struct parent *temp_parent;	/* new link */
+
+  if(intersect(node1->cube,node2->cube) == 0) return;
+  if(node1->id > node2->id)
+   { temp_node = node1;
+     node1 = node2;
+     node2 = temp_node;
+   }
+  temp_parent = alloc_parent();
+  temp_parent->parent = node2;
+  temp_parent->next_parent = node1->descendants;
+  node1->descendants = temp_parent;
+  temp_parent = alloc_parent();
+  temp_parent->parent = node1;
+  temp_parent->next_parent = node2->ancestors;
+  node2->ancestors = temp_parent;
+}
+
+/****************************************************************************/
+
+/* split_on_var puts the nodes of vector with a 0, 1 or x for var in the
+   three parts of split, one after the other, and returns the number of
+   nodes in each part in nb.						*/
+
+static split_on_var(vector,nb_nodes,var,split,nb)
+
+struct node **vector,**split;
+int nb_nodes,var,*nb;
+{
+  int i,code,pos;
+
+  nb[0] = 0;
+  nb[1] = 0;
+  nb[2] = 0;
+  for(i = 0 ; i < nb_nodes ; i++)
+   { code = extract_var(vector[i]->cube,var);
+     if(code == _0_) nb[0]++;
+     else if(code == _1_) nb[1]++;
+   }
+  nb[2] = nb_nodes - nb[0] - nb[1];
+
+  pos = 0;
+  for(i = 0 ; i < nb_nodes ; i++)
+   { if(extract_var(vector[i]->cube,var) == _0_) split[pos++] = vector[i];
+   }
+  for(i = 0 ; i < nb_nodes ; i++)
+   { if(extract_var(vector[i]->cube,var) == _1_) split[pos++] = vector[i];
+   }
+  for(i = 0 ; i < nb_nodes ; i++)
+   { if(extract_var(vector[i]->cube,var) == _X_) split[pos++] = vector[i];
+   }
+}
+
+/****************************************************************************/
+
+static struct node **alloc_split(nb_nodes)
+
+int nb_nodes;
+{
+  struct node **split;
+
+  split = (struct node **)calloc((unsigned)nb_nodes,sizeof(struct node *));
+  if(split == NULL)fatal_system_error("unable to alloc link vector");
+  return(split);
+}
+
+/****************************************************************************/
+
+link_within(vector,nb_nodes,var)
+
+struct node **vector;
+int nb_nodes,var;
+{
+  struct node **split;		/* nodes ordered by their code for var */
+
+  int
+	i,j,
+	nb[3];			/* number of nodes with 0, 1 and x */
+
+  if(nb_nodes < 2) return;
+  if(nb_nodes < LINK_SPLIT || var >= input_number)
+   { for(i = 0 ; i < nb_nodes ; i++)
+      { for(j = i + 1 ; j < nb_nodes ; j++)
+	    (*pair_action)(vector[i],vector[j]);
+      }
+     return;
+   }
+
+  split = alloc_split(nb_nodes);
+  split_on_var(vector,nb_nodes,var,split,nb);
+
+/* the nodes with 0 cannot intersect those with 1, the x part must be
+   compared with both sides and with itself.				*/
+
+  link_within(split,nb[0],var + 1);
+  link_within(split + nb[0],nb[1],var + 1);
+  link_within(split + nb[0] + nb[1],nb[2],var + 1);
+  link_between(split,nb[0],split + nb[0] + nb[1],nb[2],var + 1);
+  link_between(split + nb[0],nb[1],split + nb[0] + nb[1],nb[2],var + 1);
+  free((char *)split);
+}
+
+/****************************************************************************/
+
+link_between(vector1,nb_nodes1,vector2,nb_nodes2,var)
+
+struct node **vector1,**vector2;
+int nb_nodes1,nb_nodes2,var;
+{
+  struct node 
+	**split1,		/* first vector split along var */
+	**split2,		/* second vector split along var */
+	**part1[3],		/* start of the 0, 1 and x parts of split1 */
+	**part2[3];		/* start of the 0, 1 and x parts of split2 */
+
+  int
+	i,j,
+	nb1[3],			/* size of the parts of split1 */
+	nb2[3];			/* size of the parts of split2 */
+
+  if(nb_nodes1 == 0 || nb_nodes2 == 0) return;
+  if(nb_nodes1 * nb_nodes2 < LINK_SPLIT * LINK_SPLIT || var >= input_number)
+   { for(i = 0 ; i < nb_nodes1 ; i++)
+      { for(j = 0 ; j < nb_nodes2 ; j++)
+	    (*pair_action)(vector1[i],vector2[j]);
+      }
+     return;
+   }
+
+  split1 = alloc_split(nb_nodes1);
+  split2 = alloc_split(nb_nodes2);
+  split_on_var(vector1,nb_nodes1,var,split1,nb1);
+  split_on_var(vector2,nb_nodes2,var,split2,nb2);
+  part1[0] = split1;
+  part1[1] = split1 + nb1[0];
+  part1[2] = part1[1] + nb1[1];
+  part2[0] = split2;
+  part2[1] = split2 + nb2[0];
+  part2[2] = part2[1] + nb2[1];
+
+/* all the combinations are compared except 0 against 1 and 1 against 0 */
+
+  for(i = 0 ; i < 3 ; i++)
+   { for(j = 0 ; j < 3 ; j++)
+      { if(i + j == 1) continue;
+	link_between(part1[i],nb1[i],part2[j],nb2[j],var + 1);
+      }
+   }
+  free((char *)split1);
+  free((char *)split2);
+}
+
+/****************************************************************************/
+
+/* pair_within calls action on each pair of nodes of the vector that may
+   intersect at input, the pairs with a 0 and a 1 for the same input
+   being skipped as for the links; action checks the intersection.	*/
+
+pair_within(vector,nb_nodes,action)
+
+struct node **vector;
+int nb_nodes,(*action)();
+{
+  pair_action = action;
+  link_within(vector,nb_nodes,0);
+}
@@ -0,0 +1,392 @@
+/*********************************************************************
+
+NAME
+	cache_fetch, cache_store
+
+PURPOSE
+	The same functions are often minimized again and again, by the
+	regression flows for instance. The solutions are kept in a
+	directory, given with -cache, and found again from the function
+	instead of being computed.
+
+SYNOPSIS
+	int cache_fetch(list,path)
+	struct node *list;
+	char path[CACHE_PATH_SIZE];
+
+	cache_store(path)
+	char *path;
+
+DESCRIPTION
+    -cache_fetch computes the key of a list of nodes: a hash of
+	each cube, the hashes sorted so that the order of the cubes does
+	not matter, then hashed with the number of inputs and outputs and
+	the switches changing the solution, -min, -nint, -b, -branch and
+	-eng, each rule, time and portfolio having its own key and auto
+	being replaced by the engine it chooses for the list. When the
+	directory holds a solution for the key, it is placed in the vector
+	prime_nodes up to retained_nodes as find_best_covering leaves it,
+	with the branching depth and number of prime implicants of the
+	run that found it, and 1 is returned; 0 otherwise. The file of the
+	key is left in path in both cases.
+
+    -cache_store writes the solution in the vector in the file path found
+	by cache_fetch, then removes the solutions used the least recently
+	while the directory holds more than -cachesize Mbytes. The whole
+	function and, with -split, each group of outputs are kept under
+	their own key, so that a function edited in a few cubes finds
+	again the solution of the groups it did not change.
+
+	The solution of a key is in the file ab/abcd... of the directory,
+	named by the key in hexadecimal and placed in one of 256 sub
+	directories by its first two digits. It holds a header with the
+	size of the cubes and the cubes in binary. A file is written under
+	a temporary name in its sub directory and renamed at once, so that
+	a process reading the cache never sees an incomplete file and that
+	jobs running at the same time can share the directory. The date
+	of a file is updated each time it is found, and the eviction takes
+	the oldest files first; it is done by one process at a time, the
+	one holding the lock of the file lock in the directory.
+
+*********************************************************************/
+
+#define _XOPEN_SOURCE 600
+
+#include "cubes.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+#define CACHE_MAGIC "MCBCACHE"
+#define CACHE_VERSION 1
+
+struct cache_header
+ { char magic[8];		/* CACHE_MAGIC */
+   int version;			/* CACHE_VERSION */
+   int word_size;		/* bytes in a long int of the cubes */
+   int inputs;			/* number of inputs */
+   int outputs;			/* number of outputs */
+   int count;			/* number of cubes in the solution */
+   int branching_depth;		/* max branching depth of the run */
+   int primes;			/* number of prime implicants */
+ };
+
+struct cache_entry
+ { char name[40];		/* sub directory and file */
+   time_t date;			/* last modification */
+   long size;			/* bytes in the file */
+ };
+
+static unsigned long cache_key[2];	/* key of the last function */
+
+/***********************************************************************/
+
+/* mix_hash spreads the bits of a hash */
+
+static unsigned long mix_hash(h)
+
+unsigned long h;
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdUL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53UL;
+  h ^= h >> 33;
+  return(h);
+}
+
+/***********************************************************************/
+
+/* compare_hash orders the hashes of the cubes for qsort */
+
+static int compare_hash(a,b)
+
+unsigned long *a,*b;
+{
+  if(a[0] != b[0]) return(a[0] < b[0] ? -1 : 1);
+  if(a[1] != b[1]) return(a[1] < b[1] ? -1 : 1);
+  return(0);
+}
+
+/***********************************************************************/
+
+/* function_key hashes the cubes of the list and the switches changing the
+   solution in cache_key.						*/
+
+static function_key(list)
+
+struct node *list;
+{
+  struct node *temp_node;
+
+  unsigned long *hash,options;
+
+  char *engine;
+
+  int count,rule,verbose,i,j;
+
+  count = 0;
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+	count++;
+  hash = (unsigned long *)calloc((unsigned)(2 * count + 2),
+				 sizeof(unsigned long));
+  if(hash == NULL) fatal_system_error("unable to alloc the cache key");
+  for(i = 0, temp_node = list ; temp_node != NULL ;
+      i++, temp_node = temp_node->next_node)
+   { hash[2 * i] = 0x9e3779b97f4a7c15UL;
+     hash[2 * i + 1] = 0x2545f4914f6cdd1dUL;
+     for(j = 0 ; j < total_length ; j++)
+      { hash[2 * i] = mix_hash(hash[2 * i] ^ temp_node->cube[j]);
+	hash[2 * i + 1] = mix_hash(hash[2 * i + 1] + temp_node->cube[j] *
+				   0x100000001b3UL);
+      }
+   }
+  qsort((char *)hash,(unsigned)count,2 * sizeof(unsigned long),compare_hash);
+
+  options = (unsigned long)input_number << 40 ^
+	    (unsigned long)output_number << 16 ^ depth_limit << 2 ^
+	    DONT_MIN_LITERAL << 1 ^ DISJOINT_REQUIRED;
+
+/* each branching rule, -branch time and -branch portfolio can give
+   different solutions when the depth limit is reached, and have their
+   own keys.								*/
+
+  if(strcmp(branch_rule,"time") == 0) rule = nb_branch_rules + 1;
+  else if(strcmp(branch_rule,"portfolio") == 0) rule = nb_branch_rules + 2;
+  else rule = branch_rule_number + 1;
+  options ^= (unsigned long)rule << 56;
+
+/* the engines may place different primes in the graph, so the engine
+   is part of the key; auto is replaced by the engine it chooses for the
+   list, quietly since the choice is told again when the primes are
+   generated, and time has its own key.				*/
+
+  engine = prime_engine;
+  if(strcmp(engine,"auto") == 0)
+   { verbose = VERBOSIS;
+     VERBOSIS = 0;
+     engine = select_prime_engine(list);
+     VERBOSIS = verbose;
+   }
+  for(; *engine != '\0' ; engine++)
+	options = mix_hash(options ^ (unsigned long)*engine);
+  cache_key[0] = mix_hash(options);
+  cache_key[1] = mix_hash(~options);
+  for(i = 0 ; i < count ; i++)
+   { cache_key[0] = mix_hash(cache_key[0] ^ hash[2 * i]);
+     cache_key[1] = mix_hash(cache_key[1] ^ hash[2 * i + 1]);
+   }
+  free((char *)hash);
+}
+
+/***********************************************************************/
+
+int cache_fetch(list,path)
+
+struct node *list;
+char path[CACHE_PATH_SIZE];
+{
+  struct cache_header header;
+
+  long int *cube;
+
+  FILE *fp;
+
+  int i;
+
+  path[0] = '\0';
+  if(cache_dir[0] == '\0') return(0);
+  function_key(list);
+  sprintf(path,"%s/%02lx/%016lx%016lx",cache_dir,cache_key[0] >> 56,
+	  cache_key[0],cache_key[1]);
+  fp = fopen(path,"r");
+  if(fp == NULL) return(0);
+  if(fread((char *)&header,sizeof(header),1,fp) != 1 ||
+     memcmp(header.magic,CACHE_MAGIC,sizeof(header.magic)) != 0 ||
+     header.version != CACHE_VERSION ||
+     header.word_size != sizeof(long int) ||
+     header.inputs != input_number || header.outputs != output_number ||
+     header.count < 0)
+   { fclose(fp);
+     return(0);
+   }
+
+  cube = (long int *)calloc((unsigned)total_length,sizeof(long int));
+  prime_nodes = (struct node **)
+	calloc((unsigned)(header.count + 1),sizeof(struct node *));
+  if(cube == NULL || prime_nodes == NULL)
+	fatal_system_error("unable to allocate prime_nodes");
+  retained_nodes = prime_nodes;
+  for(i = 0 ; i < header.count ; i++)
+   { if(fread((char *)cube,sizeof(long int),(unsigned)total_length,fp) !=
+	total_length) break;
+     *(retained_nodes++) = copy_and_alloc_node(cube);
+   }
+  fclose(fp);
+  free((char *)cube);
+
+/* a file cut short is not used; the solution will be stored again */
+
+  if(i < header.count)
+   { while(retained_nodes > prime_nodes) free_node(*(--retained_nodes));
+     free((char *)prime_nodes);
+     prime_nodes = retained_nodes = NULL;
+     return(0);
+   }
+  unretain_nodes = end_prime = retained_nodes;
+  max_branching_depth = header.branching_depth;
+  prime_count = header.primes;
+  (void)utime(path,(struct utimbuf *)NULL);
+  return(1);
+}
+
+/***********************************************************************/
+
+/* compare_date orders the files of the cache, the oldest first */
+
+static int compare_date(a,b)
+
+struct cache_entry *a,*b;
+{
+  if(a->date != b->date) return(a->date < b->date ? -1 : 1);
+  return(strcmp(a->name,b->name));
+}
+
+/***********************************************************************/
+
+/* cache_evict removes the oldest files while the directory is too large */
+
+static cache_evict()
+
+{
+  struct cache_entry *entry;
+
+  struct flock lock;
+
+  struct stat status;
+
+  struct dirent *file;
+
+  DIR *directory;
+
+  char path[512];
+
+  long total,limit;
+
+  int lock_fd,count,size,sub,i;
+
+  sprintf(path,"%s/lock",cache_dir);
+  lock_fd = open(path,O_RDWR | O_CREAT,0666);
+  if(lock_fd < 0) return;
+  memset((char *)&lock,0,sizeof(lock));
+  lock.l_type = F_WRLCK;
+  lock.l_whence = SEEK_SET;
+  if(fcntl(lock_fd,F_SETLK,&lock) != 0)
+   { close(lock_fd);		/* another process is evicting */
+     return;
+   }
+
+  entry = NULL;
+  count = 0;
+  size = 0;
+  total = 0;
+  for(sub = 0 ; sub < 256 ; sub++)
+   { sprintf(path,"%s/%02x",cache_dir,sub);
+     directory = opendir(path);
+     if(directory == NULL) continue;
+     while((file = readdir(directory)) != NULL)
+      {
+/* the name of a cache file is its key in 32 hexadecimal digits; the
+   other files are not evicted, and the precisions below bound the
+   names in path and in entry.						*/
+
+	if(file->d_name[0] == '.' || strlen(file->d_name) != 32) continue;
+	sprintf(path,"%s/%02x/%.32s",cache_dir,sub,file->d_name);
+	if(stat(path,&status) != 0) continue;
+	if(count == size)
+	 { size = size ? 2 * size : 256;
+	   entry = (struct cache_entry *)realloc((char *)entry,
+			(unsigned)size * sizeof(struct cache_entry));
+	   if(entry == NULL) fatal_system_error("unable to alloc cache entries");
+	 }
+	sprintf(entry[count].name,"%02x/%.32s",sub,file->d_name);
+	entry[count].date = status.st_mtime;
+	entry[count].size = status.st_size;
+	total += status.st_size;
+	count++;
+      }
+     closedir(directory);
+   }
+
+  limit = (long)cache_size << 20;
+  if(total > limit)
+   { qsort((char *)entry,(unsigned)count,sizeof(struct cache_entry),
+	   compare_date);
+     for(i = 0 ; i < count && total > limit ; i++)
+      { sprintf(path,"%s/%s",cache_dir,entry[i].name);
+	if(unlink(path) == 0 || errno == ENOENT) total -= entry[i].size;
+      }
+     if(VERBOSIS)
+      { sprintf(error_buffer,"cache : %d solutions removed",i);
+	send_user_message(error_buffer);
+      }
+   }
+  if(entry != NULL) free((char *)entry);
+  close(lock_fd);
+}
+
+/***********************************************************************/
+
+cache_store(path)
+
+char *path;
+{
+  struct cache_header header;
+
+  struct node **cursor;
+
+  FILE *fp;
+
+  char temp_path[CACHE_PATH_SIZE + 32];
+
+  int failed;
+
+  if(path[0] == '\0') return;
+  (void)mkdir(cache_dir,0777);
+  strcpy(temp_path,path);
+  *strrchr(temp_path,'/') = '\0';
+  (void)mkdir(temp_path,0777);
+  sprintf(temp_path + strlen(temp_path),"/.tmp.%ld",(long)getpid());
+  fp = fopen(temp_path,"w");
+  if(fp == NULL)
+   { warning_user_error("unable to write in the cache directory");
+     return;
+   }
+
+  memset((char *)&header,0,sizeof(header));
+  memcpy(header.magic,CACHE_MAGIC,sizeof(header.magic));
+  header.version = CACHE_VERSION;
+  header.word_size = sizeof(long int);
+  header.inputs = input_number;
+  header.outputs = output_number;
+  header.count = retained_nodes - prime_nodes;
+  header.branching_depth = max_branching_depth;
+  header.primes = prime_count;
+  failed = fwrite((char *)&header,sizeof(header),1,fp) != 1;
+  for(cursor = prime_nodes ; cursor < retained_nodes && failed == 0 ; cursor++)
+   { failed = fwrite((char *)(*cursor)->cube,sizeof(long int),
+		     (unsigned)total_length,fp) != total_length;
+   }
+  if(fclose(fp) != 0) failed = 1;
+  if(failed || rename(temp_path,path) != 0)
+   { unlink(temp_path);
+     warning_user_error("unable to write in the cache directory");
+     return;
+   }
+  cache_evict();
+}
@@ -60,6 +60,7 @@ retain_check_node()
   free_list_of_cubes(&scanned_cube);
   free_list_of_cubes(&(scanned_node->uncovered));
   scanned_node->status = DECIDED_RETAINED;
+  touch_node(scanned_node);
   current_node = scanned_node;
   increment_pass_count();
   scan_affected_retained_ancestors();
@@ -110,6 +111,7 @@ unretain_inferior_check_node()
    }
 
   scanned_node->status = DECIDED_INFERIOR;
+  touch_node(scanned_node);
   current_node = scanned_node;
   increment_pass_count();
   scan_affected_unretain_ancestors();
@@ -338,7 +340,7 @@ check_graph()
      nb_scanned = 0;
      for(; parent_node != NULL ; parent_node = parent_node->next_node)
       { if(intersect(parent_node->cube,temp_node->cube))
-	 { if((parent_node->count | ONE) != odd_pass_counter)
+	 { if((PASS_MARK(parent_node) | ONE) != odd_pass_counter)
 	    {
 #if DEBUG
 		  foutput_cube_and_links(stderr,temp_node);
@@ -391,15 +393,15 @@ scan_intersecting_ancestors()
   for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
    { current_node = temp_parent->parent;
 
-     if(current_node->count == pass_counter) continue;
-     if(current_node->count == odd_pass_counter)
-      { current_node->count = pass_counter;
+     if(PASS_MARK(current_node) == pass_counter) continue;
+     if(PASS_MARK(current_node) == odd_pass_counter)
+      { PASS_MARK(current_node) = pass_counter;
 	scan_intersecting_ancestors();
 	continue;
       }
 
      if(intersect(scanned_node->cube,current_node->cube) == 0)continue; 
-     current_node->count = pass_counter;
+     PASS_MARK(current_node) = pass_counter;
      scan_count++;
      scan_intersecting_ancestors();
      current_node = temp_parent->parent;
@@ -416,10 +418,10 @@ scan_intersecting_descendants()
   temp_parent = current_node->descendants;
   for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
    { current_node = temp_parent->parent;
-     if((current_node->count | ONE) == odd_pass_counter) continue;
+     if((PASS_MARK(current_node) | ONE) == odd_pass_counter) continue;
      if(intersect(current_node->cube,scanned_node->cube) == 0)continue;
      scan_count++;
-     current_node->count = odd_pass_counter;
+     PASS_MARK(current_node) = odd_pass_counter;
      scan_intersecting_descendants();
    }
 }
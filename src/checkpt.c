@@ -0,0 +1,348 @@
+/*********************************************************************
+
+NAME
+	open_checkpoint, resume_checkpoint, save_checkpoint,
+	close_checkpoint
+
+PURPOSE
+	The covering of a large function can branch for hours, and a run
+	stopped before its end had to start over. The decisions which can
+	no longer change are kept in a file, given with -checkpoint, and
+	a run started again with -resume takes them back.
+
+SYNOPSIS
+	open_checkpoint()
+
+	resume_checkpoint()
+
+	save_checkpoint()
+
+	close_checkpoint()
+
+DESCRIPTION
+	The prime implicants and the essential ones do not change from a
+	run to the next on the same function, and a partition solved at
+	the first branching depth, or a node retained before any branching,
+	is never reconsidered. The state worth keeping is thus the set of
+	nodes retained at these points; the partition being solved when
+	the run stopped is solved again. The branchings inside a partition
+	are not kept: while one partition of the first depth is solved,
+	however long, the file does not change, and a function made of a
+	single large partition gains nothing from it.
+
+    -open_checkpoint is called by find_best_covering when the prime nodes
+	are in the vector. It computes a key of the prime implicants, in
+	the order of their id, to recognize them when resuming, and starts
+	the thread writing the file.
+
+    -resume_checkpoint, called with -resume once the essential prime
+	implicants are found, reads the file and retains each node it
+	lists that is not retained or covered yet; the nodes affected are
+	on the stack for recursive_find_covering. A file of another
+	function is ignored with a warning; a file cut short or listing
+	an id out of range is damaged, the nodes read before the damage
+	are kept and a warning is given.
+
+    -save_checkpoint is called where the retained nodes are final: after
+	a node is retained before any branching and after a partition of
+	the first depth is solved. When -checkperiod seconds have passed
+	since the last file at such a call, the ids of
+	the nodes from prime_nodes to retained_nodes are copied and handed
+	to the writing thread, so that the branching does not wait for
+	the disk. The file is written under a temporary name and renamed,
+	so that a run stopped while writing leaves the previous file.
+	Compiled without PARALLEL, the file is written at once.
+
+    -close_checkpoint waits for the last file and removes it, the run
+	being finished.
+
+*********************************************************************/
+
+#ifdef PARALLEL
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "cubes.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef PARALLEL
+#include <pthread.h>
+#endif
+
+#define CHECKPOINT_MAGIC "MCBCKPT"
+#define CHECKPOINT_VERSION 1
+
+struct checkpoint_header
+ { char magic[8];		/* CHECKPOINT_MAGIC */
+   int version;			/* CHECKPOINT_VERSION */
+   int inputs;			/* number of inputs */
+   int outputs;			/* number of outputs */
+   int primes;			/* number of prime implicants */
+   unsigned long key;		/* hash of the prime implicants */
+   int count;			/* number of nodes retained */
+ };
+
+static struct node **node_by_id;	/* prime node of each id */
+
+static struct checkpoint_header header;	/* header of the next file */
+
+static int
+	*pending_ids,		/* ids waiting to be written */
+	*written_ids,		/* ids being written */
+	pending_count,		/* number of ids waiting, -1 for none */
+	checkpoint_on = 0;	/* open_checkpoint was called */
+
+static double last_save;	/* wall clock of the last file */
+
+#ifdef PARALLEL
+static pthread_t writer;		/* thread writing the files */
+
+static pthread_mutex_t checkpoint_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_cond_t checkpoint_ready = PTHREAD_COND_INITIALIZER;
+
+static int writer_quit;			/* the writer should leave */
+#endif
+
+/***********************************************************************/
+
+static int write_all(fd,buffer,length)
+
+int fd;
+char *buffer;
+long length;
+{
+  long done;
+
+  while(length > 0)
+   { done = write(fd,buffer,(size_t)length);
+     if(done < 0 && errno == EINTR) continue;
+     if(done <= 0) return(0);
+     buffer += done;
+     length -= done;
+   }
+  return(1);
+}
+
+/***********************************************************************/
+
+/* write_checkpoint writes count ids in the checkpoint file */
+
+static write_checkpoint(ids,count)
+
+int *ids,count;
+{
+  char temp_path[300];
+
+  int fd,failed;
+
+  sprintf(temp_path,"%.280s.tmp",checkpoint_path);
+  fd = open(temp_path,O_WRONLY | O_CREAT | O_TRUNC,0666);
+  if(fd < 0) return;
+  header.count = count;
+  failed = write_all(fd,(char *)&header,(long)sizeof(header)) == 0 ||
+	   write_all(fd,(char *)ids,(long)count * sizeof(int)) == 0;
+  if(close(fd) != 0) failed = 1;
+  if(failed || rename(temp_path,checkpoint_path) != 0) unlink(temp_path);
+}
+
+/***********************************************************************/
+
+#ifdef PARALLEL
+
+/* checkpoint_writer writes the ids handed by save_checkpoint */
+
+static char *checkpoint_writer(arg)
+
+char *arg;
+{
+  int *ids,count;
+
+  pthread_mutex_lock(&checkpoint_lock);
+  for(; ;)
+   { while(pending_count < 0 && writer_quit == 0)
+	pthread_cond_wait(&checkpoint_ready,&checkpoint_lock);
+     if(pending_count < 0) break;
+     ids = pending_ids;
+     pending_ids = written_ids;
+     written_ids = ids;
+     count = pending_count;
+     pending_count = -1;
+     pthread_mutex_unlock(&checkpoint_lock);
+     write_checkpoint(ids,count);
+     pthread_mutex_lock(&checkpoint_lock);
+   }
+  pthread_mutex_unlock(&checkpoint_lock);
+  return(NULL);
+}
+
+#endif
+
+/***********************************************************************/
+
+/* prime_key hashes the cubes of the prime nodes in the order of their id */
+
+static unsigned long prime_key()
+
+{
+  unsigned long key;
+
+  int i,j;
+
+  key = 0xcbf29ce484222325UL;
+  for(i = 0 ; i < prime_count ; i++)
+   { for(j = 0 ; j < total_length ; j++)
+      { key = (key ^ (unsigned long)node_by_id[i]->cube[j]) * 0x100000001b3UL;
+	key ^= key >> 29;
+      }
+     key = (key ^ (unsigned long)node_by_id[i]->status) * 0x100000001b3UL;
+   }
+  return(key);
+}
+
+/***********************************************************************/
+
+open_checkpoint()
+
+{
+  struct node **cursor;
+
+  if(checkpoint_path[0] == '\0') return;
+  node_by_id = (struct node **)
+	calloc((unsigned)(prime_count + 1),sizeof(struct node *));
+  pending_ids = (int *)calloc((unsigned)(prime_count + 1),sizeof(int));
+  written_ids = (int *)calloc((unsigned)(prime_count + 1),sizeof(int));
+  if(node_by_id == NULL || pending_ids == NULL || written_ids == NULL)
+	fatal_system_error("unable to alloc the checkpoint");
+  for(cursor = prime_nodes ; cursor < end_prime ; cursor++)
+	node_by_id[(*cursor)->id] = *cursor;
+
+  memset((char *)&header,0,sizeof(header));
+  memcpy(header.magic,CHECKPOINT_MAGIC,sizeof(header.magic));
+  header.version = CHECKPOINT_VERSION;
+  header.inputs = input_number;
+  header.outputs = output_number;
+  header.primes = prime_count;
+  header.key = prime_key();
+
+  pending_count = -1;
+  last_save = trace_clock();
+  checkpoint_on = 1;
+
+#ifdef PARALLEL
+  writer_quit = 0;
+  if(pthread_create(&writer,NULL,(void *(*)())checkpoint_writer,
+		    (void *)NULL) != 0)
+	fatal_system_error("unable to start the checkpoint writer");
+#endif
+}
+
+/***********************************************************************/
+
+resume_checkpoint()
+
+{
+  struct checkpoint_header saved;
+
+  FILE *fp;
+
+  int id,count,i;
+
+  if(checkpoint_on == 0) return;
+  fp = fopen(checkpoint_path,"r");
+  if(fp == NULL)
+   { warning_user_error("no checkpoint to resume, the covering starts over");
+     return;
+   }
+  if(fread((char *)&saved,sizeof(saved),1,fp) != 1 ||
+     memcmp(saved.magic,header.magic,sizeof(saved.magic)) != 0 ||
+     saved.version != header.version || saved.inputs != header.inputs ||
+     saved.outputs != header.outputs || saved.primes != header.primes ||
+     saved.key != header.key || saved.count < 0)
+   { fclose(fp);
+     warning_user_error("the checkpoint is of another function, not resumed");
+     return;
+   }
+
+/* each node listed is retained, unless the essential prime implicants or
+   the nodes retained before already did it.				*/
+
+  count = 0;
+  for(i = 0 ; i < saved.count ; i++)
+   { if(fread((char *)&id,sizeof(int),1,fp) != 1 ||
+	id < 0 || id >= prime_count)
+      { sprintf(error_buffer,
+	   "the checkpoint is damaged, %d of its %d nodes are resumed",
+	   i,saved.count);
+	warning_user_error(error_buffer);
+	break;
+      }
+     scanned_node = node_by_id[id];
+     if(scanned_node->status & COVERED) continue;
+     scanned_cube = NULL;
+     retain_node();
+     count++;
+   }
+  fclose(fp);
+
+  sprintf(error_buffer,"%d nodes retained from the checkpoint",count);
+  if(VERBOSIS)send_user_dtime(error_buffer);
+  send_file_dtime(error_buffer);
+}
+
+/***********************************************************************/
+
+save_checkpoint()
+
+{
+  struct node **cursor;
+
+  int *ids;
+
+  double now;
+
+  if(checkpoint_on == 0) return;
+  now = trace_clock();
+  if(now - last_save < checkpoint_period) return;
+  last_save = now;
+
+#ifdef PARALLEL
+  pthread_mutex_lock(&checkpoint_lock);
+#endif
+  ids = pending_ids;
+  for(cursor = prime_nodes ; cursor < retained_nodes ; cursor++)
+	*(ids++) = (*cursor)->id;
+  pending_count = ids - pending_ids;
+#ifdef PARALLEL
+  pthread_cond_signal(&checkpoint_ready);
+  pthread_mutex_unlock(&checkpoint_lock);
+#else
+  write_checkpoint(pending_ids,pending_count);
+  pending_count = -1;
+#endif
+}
+
+/***********************************************************************/
+
+close_checkpoint()
+
+{
+  if(checkpoint_on == 0) return;
+#ifdef PARALLEL
+  pthread_mutex_lock(&checkpoint_lock);
+  pending_count = -1;
+  writer_quit = 1;
+  pthread_cond_signal(&checkpoint_ready);
+  pthread_mutex_unlock(&checkpoint_lock);
+  pthread_join(writer,NULL);
+#endif
+  (void)unlink(checkpoint_path);
+  free((char *)node_by_id);
+  free((char *)pending_ids);
+  free((char *)written_ids);
+  checkpoint_on = 0;
+}
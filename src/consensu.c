@@ -0,0 +1,381 @@
+/*********************************************************************
+
+NAME
+	prime_implicants_by_consensus, close_by_consensus
+
+PURPOSE
+	Generate the prime implicants of a boolean function by iterated
+	consensus. The recursive partitioning repeats the same merges for
+	each output when the function has many outputs and few inputs,
+	while the consensus works on the multiple output cubes directly.
+
+SYNOPSIS
+	struct node *prime_implicants_by_consensus(list)
+	struct node *list;
+
+	struct node *close_by_consensus(kept,open)
+	struct node *kept,*open;
+
+DESCRIPTION
+	The output part of a cube is taken as one multiple valued variable.
+	Two cubes with intersecting inputs have for consensus the cube with
+	the intersection of their inputs and the union of their outputs.
+	Two cubes in conflict on exactly one input variable, with some
+	output in common, have for consensus their star product along that
+	variable with the intersection of their outputs. Any other pair has
+	no consensus.
+
+	The cubes are placed in a queue and each one, in turn, produces
+	its consensus with all the cubes before it still present. A new
+	cube is added at the end of the queue unless it is contained in a
+	present cube, and the present cubes it contains are removed. When
+	the queue is exhausted the cubes present are the prime implicants.
+
+	To find quickly the containments, the present cubes are kept in a
+	containment index by number of literals at input: a cube may
+	only be contained in a cube with as many or fewer literals.
+
+	The dont care bits are taken as 1 during the generation and the
+	dont care cover is placed in separate DONT_CARE nodes; the nodes
+	are then linked together by link_prime_list. The list received is
+	consumed; the list returned contains the dont care nodes followed
+	by the prime implicants.
+
+	close_by_consensus adds the cubes of the list open, the dont care
+	taken as 1, to the prime implicants of the list kept, which may
+	miss the primes needing the open cubes but are otherwise closed:
+	the consensus of two kept nodes is only computed when one of them
+	has a nonzero id, the others being known to give a cube contained
+	in a kept node. The queue starts with the kept nodes, those with a
+	nonzero id last, and the consensus are produced from the first of
+	these. The kept nodes keep their links; the new prime implicants
+	are returned, in a list with the status BASIC, and the kept nodes
+	they contain are left with a null status. The list open is not
+	changed.
+
+*********************************************************************/
+
+#include "cubes.h"
+#include <stdlib.h>
+
+#define PRESENT 1		/* status of a cube in the index */
+#define ABSORBED 0		/* status of a cube contained in another */
+#define INITIAL_QUEUE 256	/* initial size of the queue */
+
+struct bucket
+ { struct node **cube;		/* cubes with this number of literals */
+   int count;			/* number of cubes in the bucket */
+   int size;			/* number of cubes allocated */
+ };
+
+static struct node
+	**queue;		/* all the cubes in order of generation */
+
+static int
+	queue_count,		/* number of cubes in the queue */
+	queue_size;		/* number of cubes allocated in the queue */
+
+static struct bucket
+	*literal_index;		/* present cubes by number of literals */
+
+/***********************************************************************/
+
+static add_to_bucket(bucket,node)
+
+struct bucket *bucket;
+struct node *node;
+{
+  if(bucket->count == bucket->size)
+   { bucket->size = bucket->size == 0 ? 16 : 2 * bucket->size;
+     bucket->cube = (struct node **)realloc((char *)bucket->cube,
+		(unsigned)bucket->size * sizeof(struct node *));
+     if(bucket->cube == NULL)
+	fatal_system_error("unable to alloc consensus index");
+   }
+  bucket->cube[bucket->count++] = node;
+}
+
+/***********************************************************************/
+
+/* start_queue allocates an empty queue and containment index, and
+   end_queue frees them.						*/
+
+static start_queue()
+
+{
+  queue_size = INITIAL_QUEUE;
+  queue_count = 0;
+  queue = (struct node **)calloc((unsigned)queue_size,sizeof(struct node *));
+  literal_index = (struct bucket *)
+	calloc((unsigned)(input_number + 1),sizeof(struct bucket));
+  if(queue == NULL || literal_index == NULL)
+	fatal_system_error("unable to alloc consensus queue");
+}
+
+static end_queue()
+
+{
+  int i;
+
+  for(i = 0 ; i <= input_number ; i++)
+   { if(literal_index[i].cube != NULL) free((char *)literal_index[i].cube);
+   }
+  free((char *)literal_index);
+  free((char *)queue);
+}
+
+/***********************************************************************/
+
+/* enter_cube places a node present at the end of the queue and in the
+   index.								*/
+
+static enter_cube(node)
+
+struct node *node;
+{
+  if(queue_count == queue_size)
+   { queue_size *= 2;
+     queue = (struct node **)realloc((char *)queue,
+		(unsigned)queue_size * sizeof(struct node *));
+     if(queue == NULL) fatal_system_error("unable to alloc consensus queue");
+   }
+  node->status = PRESENT;
+  queue[queue_count++] = node;
+  add_to_bucket(literal_index + input_cost(node->cube),node);
+}
+
+/***********************************************************************/
+
+/* insert_cube places the cube of spare_node in the queue and in the index
+   unless it is contained in a present cube. The cubes it contains are
+   removed from the index. It returns 1 when the cube is inserted.     */
+
+static int insert_cube()
+
+{
+  struct bucket *bucket;	/* bucket of the index examined */
+
+  struct node *temp_node;	/* cube in the bucket */
+
+  int cost,i,j;
+
+  cost = input_cost(spare_node->cube);
+  for(i = 0 ; i <= cost ; i++)
+   { bucket = literal_index + i;
+     for(j = 0 ; j < bucket->count ; j++)
+      { if(covers(bucket->cube[j]->cube,spare_node->cube)) return(0);
+      }
+   }
+
+  for(i = cost ; i <= input_number ; i++)
+   { bucket = literal_index + i;
+     for(j = 0 ; j < bucket->count ;)
+      { temp_node = bucket->cube[j];
+	if(covers(spare_node->cube,temp_node->cube))
+	 { temp_node->status = ABSORBED;
+	   bucket->cube[j] = bucket->cube[--bucket->count];
+	 }
+	else j++;
+      }
+   }
+
+  enter_cube(spare_node);
+  spare_node = alloc_node();
+  return(1);
+}
+
+/***********************************************************************/
+
+/* consensus puts in the spare node the consensus of two cubes and returns
+   1, or returns 0 when they have no consensus.			*/
+
+static int consensus(cube1,cube2)
+
+long int *cube1,*cube2;
+{
+  long int
+	*result,	/* cube being built */
+	word,		/* intersection of a word of the cubes */
+	conflict,	/* 10 for each variable with a null intersection */
+	common;		/* outputs in common */
+
+  int
+	i,
+	conflict_word;	/* word holding the conflicting variable */
+
+  result = spare_node->cube;
+  conflict_word = -1;
+  for(i = 0 ; i < input_length ; i++)
+   { word = cube1[i] & cube2[i];
+     conflict = ~((word << 1) | word) & mask10;
+     if(conflict != 0L)
+      { if(conflict_word >= 0 || (conflict & (conflict - 1)) != 0L)
+	    return(0);
+	conflict_word = i;
+	word |= conflict | (conflict >> 1);
+      }
+     result[i] = word;
+   }
+
+  common = 0L;
+  for(; i < total_length ; i++)
+   { common |= cube1[i] & cube2[i];
+     if(conflict_word >= 0) result[i] = cube1[i] & cube2[i];
+     else result[i] = cube1[i] | cube2[i];
+   }
+  if(conflict_word >= 0 && common == 0L) return(0);
+  return(1);
+}
+
+/***********************************************************************/
+
+struct node
+*prime_implicants_by_consensus(list)
+
+struct node *list;
+{
+  struct node
+	*temp_node,	/* node in the list */
+	*next_node,	/* next node in the list */
+	*dont_care,	/* nodes of the dont care cover */
+	*prime_list;	/* prime implicants found */
+
+  int
+	generated,	/* number of consensus cubes inserted */
+	i,j;
+
+  if(DISJOINT_REQUIRED) check_disjoint_input(list);
+  start_queue();
+
+/* the cubes received are placed in the queue with their dont care at 1,
+   and their dont care part is kept as a dont care node.		*/
+
+  dont_care = NULL;
+  for(temp_node = list ; temp_node != NULL ; temp_node = next_node)
+   { next_node = temp_node->next_node;
+     if(empty_output(temp_node->cube) == 0)
+      { copy_cube(temp_node->cube,spare_node->cube);
+	change_dont_to_do_care(spare_node->cube);
+	(void)insert_cube();
+	if(detect_dont_care(temp_node->cube))
+	 { temp_node->next_node = dont_care;
+	   dont_care = temp_node;
+	   remove_do_care(temp_node->cube);
+	   temp_node->status = DONT_CARE;
+	   continue;
+	 }
+      }
+     free_node(temp_node);
+   }
+
+/* each cube of the queue, while still present, produces its consensus
+   with all the present cubes before it in the queue.			*/
+
+  generated = 0;
+  for(i = 0 ; i < queue_count ; i++)
+   { PROGRESS();
+     for(j = 0 ; j < i && queue[i]->status == PRESENT ; j++)
+      { if(queue[j]->status == PRESENT &&
+	   consensus(queue[i]->cube,queue[j]->cube))
+	  generated += insert_cube();
+      }
+   }
+
+/* the cubes still present are the prime implicants, the others are
+   released.								*/
+
+  prime_list = NULL;
+  for(i = queue_count - 1 ; i >= 0 ; i--)
+   { temp_node = queue[i];
+     if(temp_node->status == PRESENT)
+      { temp_node->status = BASIC;
+	temp_node->next_node = prime_list;
+	prime_list = temp_node;
+      }
+     else free_node(temp_node);
+   }
+
+  if(VERBOSIS)
+   { sprintf(error_buffer,
+	"consensus engine : %d cubes queued, %d consensus inserted",
+	queue_count,generated);
+     send_user_message(error_buffer);
+   }
+
+  end_queue();
+
+  list = merge_node_lists(dont_care,prime_list);
+  link_prime_list(list);
+  return(list);
+}
+
+/***********************************************************************/
+
+struct node
+*close_by_consensus(kept,open)
+
+struct node *kept,*open;
+{
+  struct node
+	*temp_node,	/* node in the lists */
+	*added,		/* prime implicants added */
+	**added_end;	/* where the next one goes */
+
+  int
+	nb_kept,	/* number of kept nodes */
+	first,		/* first cube of the queue paired with the others */
+	generated,	/* number of consensus cubes inserted */
+	i,j;
+
+  start_queue();
+
+/* the kept nodes are entered as they are, the cubes of open as in
+   prime_implicants_by_consensus.					*/
+
+  for(temp_node = kept ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { if(temp_node->id == 0) enter_cube(temp_node);
+   }
+  first = queue_count;
+  for(temp_node = kept ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { if(temp_node->id != 0) enter_cube(temp_node);
+   }
+  nb_kept = queue_count;
+  for(temp_node = open ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { if(empty_output(temp_node->cube)) continue;
+     copy_cube(temp_node->cube,spare_node->cube);
+     change_dont_to_do_care(spare_node->cube);
+     (void)insert_cube();
+   }
+
+  generated = 0;
+  for(i = first ; i < queue_count ; i++)
+   { PROGRESS();
+     for(j = 0 ; j < i && queue[i]->status == PRESENT ; j++)
+      { if(queue[j]->status == PRESENT &&
+	   consensus(queue[i]->cube,queue[j]->cube))
+	  generated += insert_cube();
+      }
+   }
+
+  added = NULL;
+  added_end = &added;
+  for(i = nb_kept ; i < queue_count ; i++)
+   { temp_node = queue[i];
+     if(temp_node->status == PRESENT)
+      { temp_node->status = BASIC;
+	*added_end = temp_node;
+	added_end = &temp_node->next_node;
+      }
+     else free_node(temp_node);
+   }
+  *added_end = NULL;
+
+  if(VERBOSIS)
+   { sprintf(error_buffer,
+	"consensus update : %d kept, %d paired, %d queued, %d inserted",
+	nb_kept,nb_kept - first,queue_count - nb_kept,generated);
+     send_user_message(error_buffer);
+   }
+  end_queue();
+  return(added);
+}
@@ -0,0 +1,257 @@
+/********************************************************************
+
+NAME
+	cubebnch
+
+PURPOSE
+	Measure alone each primitive of the cube library, to evaluate the
+	changes made to them before they are used by the algorithms.
+
+SYNOPSIS
+	cubebnch [-inputs n] [-outputs n] [-cubes n] [-xdensity %]
+		 [-ops n] [-seed n] [-file input]
+
+DESCRIPTION
+	The cubes are read with fread_nodes, as verify does, from the file
+	given with -file or from a temporary file filled with random cubes:
+	-cubes cubes (1000) of -inputs inputs (32) and -outputs outputs (8),
+	each input at x with the probability -xdensity in percent (30) and
+	each output at 1 with probability 1/2. The same -seed gives the
+	same cubes.
+
+	Each of star_product, covers, absorb, intersect, disjoint_sharp,
+	or_output, and_output and input_cost is then called -ops times
+	(1000000) on pairs of cubes taken in turn from the list, and its
+	time per call in nanoseconds and number of cubes processed per
+	second are printed. For star_product half of the pairs are made
+	adjacent on the variable defined, so that both the early exit and
+	the merge are measured; the current variable is defined before
+	each call. disjoint_sharp is measured with the copy of the first
+	cube into a cube list and its release after the sharp.
+
+*********************************************************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "cubes.h"
+#include "param.h"
+#include <stdlib.h>
+#include <time.h>
+
+FILE *input_file, *output_file;
+
+int
+	nb_inputs = 32,		/* inputs of the random cubes */
+	nb_outputs = 8,		/* outputs of the random cubes */
+	nb_cubes = 1000,	/* number of random cubes */
+	x_density = 30,		/* percent of x at input */
+	nb_ops = 1000000,	/* calls of each primitive */
+	seed = 1,		/* seed of the random cubes */
+	VERBOSIS = 0,		/* used by the allocation routines */
+	memory_limit = 0;	/* no memory budget */
+
+char
+	read_interminator = ' ',
+	read_outterminator = '\n',
+	*print_interminator = " ",
+	*print_outterminator = "\n";
+
+struct p_file
+	p1 = {"in","r",&input_file};
+
+struct p_integer
+	p2 = {1,4096,&nb_inputs},
+	p3 = {1,4096,&nb_outputs},
+	p4 = {2,1000000,&nb_cubes},
+	p5 = {0,100,&x_density},
+	p6 = {1,1000000000,&nb_ops},
+	p7 = {0,1000000000,&seed};
+
+struct parameter parmv[]
+     = {"inputs","inputs of the cubes",P_INTEGER,0,0,P_OPTIONAL,(char *)&p2,
+	"outputs","outputs of the cubes",P_INTEGER,0,0,P_OPTIONAL,(char *)&p3,
+	"cubes","number of cubes",P_INTEGER,0,0,P_OPTIONAL,(char *)&p4,
+	"xdensity","percent of x at input",P_INTEGER,0,0,P_OPTIONAL,(char *)&p5,
+	"ops","calls of each function",P_INTEGER,0,0,P_OPTIONAL,(char *)&p6,
+	"seed","random seed",P_INTEGER,0,0,P_OPTIONAL,(char *)&p7,
+	"file","input",P_FILE,0,0,P_OPTIONAL,(char *)&p1};
+
+int parmc = sizeof(parmv) / sizeof(struct parameter);
+
+static struct node **cube_vector;	/* the cubes read */
+
+static int vector_count;		/* number of cubes read */
+
+static long sink;			/* results, to keep the calls */
+
+/***********************************************************************/
+
+static double clock_ns()
+
+{
+  struct timespec now;
+
+  if(clock_gettime(CLOCK_MONOTONIC,&now) != 0) return(0.0);
+  return(now.tv_sec * 1e9 + now.tv_nsec);
+}
+
+/***********************************************************************/
+
+/* random_file writes random cubes in a temporary file and returns it */
+
+static FILE *random_file()
+
+{
+  FILE *fp;
+
+  int i,j;
+
+  fp = tmpfile();
+  if(fp == NULL) fatal_system_error("unable to create a temporary file");
+  srand((unsigned)seed);
+  for(i = 0 ; i < nb_cubes ; i++)
+   { for(j = 0 ; j < nb_inputs ; j++)
+      { if(rand() % 100 < x_density) putc('x',fp);
+	else putc(rand() & 1 ? '1' : '0',fp);
+      }
+     putc(' ',fp);
+     for(j = 0 ; j < nb_outputs ; j++) putc(rand() & 1 ? '1' : '0',fp);
+     putc('\n',fp);
+   }
+  rewind(fp);
+  return(fp);
+}
+
+/***********************************************************************/
+
+static report(name,start,cubes_per_op)
+
+char *name;
+double start;
+int cubes_per_op;
+{
+  double ns;
+
+  ns = (clock_ns() - start) / nb_ops;
+  printf("%-16s %12.2f ns/op %14.0f cubes/s\n",name,ns,
+	 ns > 0.0 ? cubes_per_op * 1e9 / ns : 0.0);
+}
+
+/***********************************************************************/
+
+main(argc,argv)
+
+int argc;
+char **argv;
+{
+  struct node *list, *temp_node, **adjacent;
+
+  struct cube_list *temp_cube;
+
+  long int *cube1, *cube2;
+
+  double start;
+
+  int i, j, *var;
+
+  input_file = NULL;
+  output_file = stdout;
+  param(parmc,parmv,argc,argv);
+  if(input_file == NULL) input_file = random_file();
+
+  vector_count = fread_nodes(input_file,&list);
+  if(vector_count < 2) fatal_user_error("at least 2 cubes are needed");
+  cube_vector = (struct node **)
+	calloc((unsigned)vector_count,sizeof(struct node *));
+  adjacent = (struct node **)
+	calloc((unsigned)vector_count,sizeof(struct node *));
+  var = (int *)calloc((unsigned)vector_count,sizeof(int));
+  if(cube_vector == NULL || adjacent == NULL || var == NULL)
+	fatal_system_error("unable to alloc the cubes");
+
+/* for each cube a variable is chosen and, for half of the cubes, a cube
+   adjacent along it is made for the star product.			*/
+
+  for(i = 0, temp_node = list ; temp_node != NULL ;
+      i++, temp_node = temp_node->next_node)
+	cube_vector[i] = temp_node;
+  for(i = 0 ; i < vector_count ; i++)
+   { var[i] = rand() % input_number;
+     j = (i + 1) % vector_count;
+     define_current_var(var[i]);
+     if(i & 1 || extract_current_var(cube_vector[i]->cube) == _X_)
+	adjacent[i] = cube_vector[j];
+     else
+      { adjacent[i] = copy_and_alloc_node(cube_vector[i]->cube);
+	set_current_var(adjacent[i]->cube,
+	    extract_current_var(cube_vector[i]->cube) == _1_ ? mask10 : mask01);
+      }
+   }
+
+  printf("%d cubes, %d inputs, %d outputs, %d calls of each function\n",
+	 vector_count,input_number,output_number,nb_ops);
+
+  start = clock_ns();
+  for(i = 0, j = 0 ; i < nb_ops ; i++, j = j + 1 == vector_count ? 0 : j + 1)
+   { define_current_var(var[j]);
+     sink += star_product(cube_vector[j]->cube,adjacent[j]->cube,
+			  spare_node->cube);
+   }
+  report("star_product",start,2);
+
+  start = clock_ns();
+  for(i = 0, j = 0 ; i < nb_ops ; i++, j = j + 1 == vector_count ? 0 : j + 1)
+   { cube1 = cube_vector[j]->cube;
+     cube2 = cube_vector[j + 1 == vector_count ? 0 : j + 1]->cube;
+     sink += covers(cube1,cube2);
+   }
+  report("covers",start,2);
+
+  start = clock_ns();
+  for(i = 0, j = 0 ; i < nb_ops ; i++, j = j + 1 == vector_count ? 0 : j + 1)
+   { cube1 = cube_vector[j]->cube;
+     cube2 = cube_vector[j + 1 == vector_count ? 0 : j + 1]->cube;
+     sink += absorb(cube1,cube2);
+   }
+  report("absorb",start,2);
+
+  start = clock_ns();
+  for(i = 0, j = 0 ; i < nb_ops ; i++, j = j + 1 == vector_count ? 0 : j + 1)
+   { cube1 = cube_vector[j]->cube;
+     cube2 = cube_vector[j + 1 == vector_count ? 0 : j + 1]->cube;
+     sink += intersect(cube1,cube2);
+   }
+  report("intersect",start,2);
+
+  start = clock_ns();
+  for(i = 0, j = 0 ; i < nb_ops ; i++, j = j + 1 == vector_count ? 0 : j + 1)
+   { temp_cube = copy_and_alloc_cube_list(cube_vector[j]->cube);
+     sink += disjoint_sharp(&temp_cube,
+		cube_vector[j + 1 == vector_count ? 0 : j + 1]->cube);
+     free_list_of_cubes(&temp_cube);
+   }
+  report("disjoint_sharp",start,2);
+
+  start = clock_ns();
+  for(i = 0, j = 0 ; i < nb_ops ; i++, j = j + 1 == vector_count ? 0 : j + 1)
+   { or_output(cube_vector[j]->cube,spare_node->cube);
+   }
+  sink += spare_node->cube[total_length - 1];
+  report("or_output",start,2);
+
+  start = clock_ns();
+  for(i = 0, j = 0 ; i < nb_ops ; i++, j = j + 1 == vector_count ? 0 : j + 1)
+   { and_output(cube_vector[j]->cube,spare_node->cube);
+   }
+  sink += spare_node->cube[total_length - 1];
+  report("and_output",start,2);
+
+  start = clock_ns();
+  for(i = 0, j = 0 ; i < nb_ops ; i++, j = j + 1 == vector_count ? 0 : j + 1)
+   { sink += input_cost(cube_vector[j]->cube);
+   }
+  report("input_cost",start,1);
+
+  if(sink == 42) printf("\n");
+  exit(0);
+}
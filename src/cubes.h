@@ -21,6 +21,8 @@ AUTHOR
 ***************************************************************************/
 
 #include <stdio.h>
+#include <setjmp.h>
+#include <signal.h>
 
 #define LEAF 1
 #define SUBTREE 2
@@ -51,7 +53,7 @@ struct node
    struct cube_list *uncovered;	/* part of node uncovered by retained nodes */
    short int status;		/* a short word for status information */
    short int cost;		/* number of non x input in the cube */
-   long int count;		/* pass count when the node was last visited */
+   int id;			/* place in the prime vector of the covering */
    long int cube[2];		/* cube of length to determine on allocation */
  };
 
@@ -143,6 +145,23 @@ int
 	flush_parent(),		/* release all the parents */
 	free_list_of_parents();	/* release a list of parents */
 
+int
+	report_alloc_stats(),	/* send the statistics of the pools */
+	foutput_alloc_stats();	/* write them to a file in JSON */
+
+long alloc_bytes_reserved();	/* bytes reserved in all the pools */
+
+int
+	charge_memory(),	/* count bytes allocated outside the pools */
+	release_memory();	/* count bytes released outside the pools */
+
+#define MEMORY_OVER 1		/* the memory budget was exceeded */
+#define MEMORY_CUT 2		/* the prime generation was stopped by it */
+
+extern int memory_exceeded;	/* MEMORY_OVER and MEMORY_CUT when reached */
+
+extern jmp_buf *memory_escape;	/* where to go when the budget is reached */
+
 extern int
 	nb_alloc_parent,
 	nb_alloc_cube_list,
@@ -299,7 +318,12 @@ int
 	pass_ancestors(),	/* change the address of ancestors */
 	pass_descendants(),	/* change the address of descendants */
 	remove_ancestors(),	/* remove the links from the graph */
-	absorb_and_unlink();	/* remove a node from the graph */
+	absorb_and_unlink(),	/* remove a node from the graph */
+	link_prime_list(),	/* link all intersecting nodes of a list */
+	link_added_nodes(),	/* link the nodes at the end of a list */
+	link_within(),		/* link the nodes of a vector together */
+	link_between(),		/* link the nodes of two vectors */
+	pair_within();		/* visit the pairs which may intersect */
 
 
 /*	Select.c	*/
@@ -308,7 +332,8 @@ int
 	max(),			/* returns the max value of 2 int */
 	select_input(),		/* using heuristic select an input */
 	put_in_dont_care_list(), /* put the dont care part of a node in a list*/
-	put_in_common_list();	/* change a tree structure into a list */
+	put_in_common_list(),	/* change a tree structure into a list */
+	check_disjoint_input();	/* refuse cubes intersecting at input */
 
 
 /*	Prime.c	       */
@@ -338,6 +363,172 @@ int
 	merge_with_rest();		/* try merge a node with all in is1 */
 
 
+/*	Consensu.c	*/
+
+struct node
+	*prime_implicants_by_consensus(),	/* generate PIs by consensus */
+	*close_by_consensus();		/* add cubes to a set of PIs */
+
+
+/*	Progress.c	*/
+
+int
+	start_progress(),	/* arm the timer of the progress reports */
+	report_progress(),	/* print and write the state of the run */
+	stop_progress();	/* disarm the timer */
+
+extern volatile sig_atomic_t progress_due;	/* a report is due */
+
+#define PROGRESS() { if(progress_due) report_progress(); }
+
+
+/*	Trace.c		*/
+
+double trace_clock();		/* wall clock in seconds */
+
+int
+	write_trace(),		/* write a decision in the trace file */
+	close_trace();		/* close the trace file */
+
+
+/*	Expand.c	*/
+
+struct node
+	*prime_implicants_by_expansion();	/* expand each cube to a PI */
+
+
+/*	Checkpt.c	*/
+
+int
+	open_checkpoint(),	/* prepare the checkpoint of the covering */
+	resume_checkpoint(),	/* retain again the nodes of the checkpoint */
+	save_checkpoint(),	/* keep the nodes retained when it is time */
+	close_checkpoint();	/* the covering is done, remove the file */
+
+
+/*	Primfile.c	*/
+
+#define PRIME_ALL 1		/* all the prime implicants are in the graph */
+#define PRIME_LINKED 2		/* every pair of intersecting nodes is linked */
+
+unsigned long function_hash();	/* hash of the cubes read */
+
+int
+	save_prime_implicants(),	/* write the graph of the PIs in a file */
+	save_prime_cover();		/* add the cover found to the file */
+
+struct node
+	*load_prime_implicants();	/* read it back */
+
+
+/*	Delta.c		*/
+
+int
+	apply_delta(),		/* add and remove cubes of the function read */
+	reuse_previous_cover();	/* retain the cover of the untouched parts */
+
+struct node
+	*update_prime_implicants();	/* change the PIs saved by the delta */
+
+
+/*	Serve.c		*/
+
+int serve_requests();		/* minimize the functions sent on a socket */
+
+
+/*	Cache.c		*/
+
+#define CACHE_PATH_SIZE 512	/* size of the path of a cache file */
+#define CACHE_DIR_SIZE 400	/* longest name of the cache directory */
+
+int
+	cache_fetch(),		/* find the solution of a function in cache */
+	cache_store();		/* keep the solution in the cache */
+
+
+/*	Equiv.c		*/
+
+int verify_cover();		/* check a solution against the function */
+
+
+/*	Autosel.c	*/
+
+struct node
+	*generate_prime_implicants();	/* generate PIs with an engine */
+
+char
+	*select_prime_engine(),		/* choose an engine from statistics */
+	*time_prime_engines();		/* choose the fastest engine */
+
+int time_branch_rules();		/* choose the best branching rule */
+
+extern int prime_graph;		/* PRIME_ALL and PRIME_LINKED, last engine */
+
+
+/*	Portfoli.c	*/
+
+int
+	portfolio_covering(),	/* cover with workers of different rules */
+	portfolio_bound(),	/* a worker leaves when it can not win */
+	portfolio_cut();	/* a worker can not win with so many nodes */
+
+
+/*	Outsplit.c	*/
+
+int minimize_by_output_components();	/* minimize each output group */
+
+
+/*	Profile.c	*/
+
+#define PHASE_READ 0
+#define PHASE_PRIME 1
+#define PHASE_EPI 2
+#define PHASE_BRANCH 3
+#define PHASE_SPARSE 4
+#define PHASE_WRITE 5
+#define PHASE_SPLIT 6
+#define PHASE_VERIFY 7
+#define NB_PHASES 8
+
+/* the operation counters are only compiled with COUNTERS */
+
+#define COUNT_STAR_CALL 0	/* star_product called */
+#define COUNT_STAR_MERGE 1	/* star_product merged the cubes */
+#define COUNT_COVERS 2		/* covers called */
+#define COUNT_ABSORB 3		/* absorb called */
+#define COUNT_SHARP_SPLIT 4	/* cubes split by a disjoint sharp */
+#define COUNT_INTERSECT_VISIT 5	/* cubes visited by intersect_list */
+#define COUNT_SCAN_PASS 6	/* passes of the graph scans */
+#define COUNT_SCAN_VISIT 7	/* nodes visited by the graph scans */
+#define COUNT_MERGE_CASE 8	/* merge_and_link cases 0 to 3, 4 counters */
+#define NB_COUNTERS 12
+
+extern int current_phase;	/* phase begun last, -1 before any */
+
+extern char *phase_name[NB_PHASES];	/* names of the phases */
+
+#ifdef COUNTERS
+extern long op_counter[NB_COUNTERS];
+#define COUNT(counter) (op_counter[counter]++)
+#else
+#define COUNT(counter)
+#endif
+
+int
+	profile_begin(),	/* start timing a phase */
+	profile_end(),		/* stop timing a phase */
+	profile_report();	/* print and write the times of the phases */
+
+
+/*	Zdd.c		*/
+
+struct node
+	*prime_implicants_by_zdd();	/* generate PIs implicitly */
+
+int
+	zdd_cleanup();			/* free the tables of the engine */
+
+
 /*	Solve.c		*/
 
 #define COVERED 2 
@@ -352,10 +543,30 @@ int
 #define DECIDED_COVERED 10
 #define DECIDED_INFERIOR 8
 #define PRIME_ESSENTIAL 64
+#define ESSENTIAL_FOUND 256
+
+/* a sharp_arena holds the cubes of a disjoint sharp in two vectors used
+   in turn, so that threads can sharp without the common cube pool	*/
+
+struct sharp_arena
+ { long int *cube[2];		/* the two vectors of cubes */
+   int count[2];		/* number of cubes in each vector */
+   int size[2];			/* number of cubes allocated in each vector */
+   int side;			/* vector holding the current cubes */
+#ifdef COUNTERS
+   long splits;			/* cubes split by the sharps */
+#endif
+ };
 
 int
 	recursive_find_covering(),	/* find the best set of cubes */
-	essential_prime_implicants();	/* find the essential prime imp. */
+	find_essential_nodes(),		/* mark the essential nodes */
+	essential_prime_implicants(),	/* find the essential prime imp. */
+	arena_sharp(),			/* sharp the cubes of an arena */
+	free_covering();		/* free the graph once covered */
+
+long int
+	*arena_push();			/* add a cube in an arena */
 
 extern struct node 
 	**prime_nodes,		/* vector containing pointer to all cubes */
@@ -380,10 +591,17 @@ extern int
 	branching_depth;	/* depth in recursion while branching */
 
 extern unsigned long int
-	ONE,			/* a constant 1 unsigned long int */
+	ONE;			/* a constant 1 unsigned long int */
+
+extern unsigned int
+	*pass_mark,		/* pass count when each node was last visited */
 	odd_pass_counter,	/* pass counter + 1 to identify scanning dir.*/
 	pass_counter;		/* counts the number of scanning pass */
 
+/* the pass count of a node, kept in pass_mark at the place of its id */
+
+#define PASS_MARK(node) (pass_mark[(node)->id])
+
 
 /*	Place.c	       */
 
@@ -394,8 +612,26 @@ int
 	select_node(),		/* upon cycle choose a node to retain */
 	increment_pass_count(),	/* increment the pass counter */
 	init_pass_count(),	/* when pass counter overflows reinit all */
+	init_node_scores(),	/* no node has its score for select_node */
+	touch_node(),		/* a node changed, its parents are rescored */
+	set_branch_rule(),	/* choose the rule of select_node by name */
 	push();			/* place an affected node on the stack */
 
+struct branch_entry
+ { char *name;			/* name given with -branch */
+   int (*score)();		/* score of an undecided node */
+ };
+
+extern struct branch_entry branch_rules[];	/* rules of select_node */
+
+extern int
+	select_score,		/* score of the node chosen by select_node */
+	*node_score,		/* score of each node, -1 when it changed */
+	nb_branch_rules,	/* number of rules in branch_rules */
+	branch_rule_number;	/* rule used by select_node */
+
+extern unsigned long random_seed;	/* seed of the rule random */
+
 struct node
 	*pop();			/* take next node from the stack */
 
@@ -403,6 +639,7 @@ struct node
 /*	Scan.c		*/
 
 int
+	init_scan_stack(),			/* size the work stack */
 	scan_affected_retained_ancestors(),	/* recursive routines to scan */
 	scan_sffected_retained_descendants(),	/* nodes in the graph         */
 	scan_affected_inferior_ancestors(),
@@ -419,7 +656,11 @@ int
 /*	Mcboole.c	*/
 
 extern FILE
-	*output_file;		/* file on which we print the result */
+	*output_file,		/* file on which we print the result */
+	*stats_file,		/* file receiving the statistics in JSON */
+	*trace_file,		/* file receiving the branching trace */
+	*add_file,		/* cubes added to the function, if any */
+	*del_file;		/* cubes removed from the function, if any */
 
 extern int
 	EPI_LIST,
@@ -427,6 +668,15 @@ extern int
 	VERBOSIS,		/* give plenty of messages to user */
 	VERY_VERBOSIS,		/* even more messages */
 	DONT_MIN_LITERAL,	/* minimize only the number of product term */
+	SPLIT_OUTPUTS,		/* minimize each group of outputs separately */
+	PROGRESS_LINE,		/* print the progress each second */
+	VERIFY_COVER,		/* check the solution against the function */
+	RESUME_COVERING,	/* resume the covering from the checkpoint */
+	checkpoint_period,	/* seconds between two checkpoints */
+	max_jobs,		/* processes working at the same time */
+	memory_limit,		/* memory budget in Mbytes, 0 for none */
+	cache_size,		/* size of the cache in Mbytes */
+	stats_cubes,		/* number of cubes read */
 	max_branching_depth,	/* deepest braching depth reached */
 	depth_limit;		/* depth limit allowed */
 
@@ -434,7 +684,20 @@ extern char
 	read_interminator,	/* character that ends input part for reading*/
 	read_outterminator,	/* character that ends the cube when reading */
 	*print_interminator,	/* string printed after input part */
-	*print_outterminator;	/* string printed after output part */
+	*print_outterminator,	/* string printed after output part */
+	*prime_engine,		/* engine generating the prime implicants */
+	*calib_file,		/* samples for the engine selection */
+	*status_path,		/* file receiving the progress, if any */
+	*cache_dir,		/* directory of the solutions kept, if any */
+	*serve_path,		/* socket of the server mode, if any */
+	*checkpoint_path,	/* checkpoint of the covering, if any */
+	*save_primes_path,	/* file receiving the prime implicants */
+	*load_primes_path,	/* file giving the prime implicants */
+	*branch_rule;		/* rule choosing the branching node */
+
+int
+	minimize(),		/* minimize the function of input_file */
+	quiet_child();		/* keep a child off the files of the parent */
 
 
 /*
@@ -0,0 +1,482 @@
+/*********************************************************************
+
+NAME
+	apply_delta, update_prime_implicants, reuse_previous_cover
+
+PURPOSE
+	A function is often changed in a few cubes, for an engineering
+	change, and minimized again. The cubes added and removed are
+	given in two files, -add and -del, instead of a new function, and
+	the prime implicants and the cover of the previous run, kept with
+	-save-primes, are only changed where the delta touches them.
+
+SYNOPSIS
+	int apply_delta(list)
+	struct node **list;
+
+	struct node *update_prime_implicants(function,list)
+	unsigned long function;
+	struct node *list;
+
+	reuse_previous_cover(list)
+	struct node *list;
+
+DESCRIPTION
+    -apply_delta changes the list read. The cubes of the file -del, in
+	the format of the input file, are removed from it for the outputs
+	where they have a 1 or a dont care: each cube of the list they
+	intersect is replaced by the cubes of its disjoint sharp with them,
+	so that their part is cut from the on set and from the dont care
+	set, and the user is warned about the cubes intersecting no cube.
+	The cubes of the file -add are then placed at the end of the list,
+	and the number of cubes in the list is returned. With -load-primes
+	both sets of cubes are kept for update_prime_implicants.
+
+    -update_prime_implicants is called with -load-primes instead of
+	load_prime_implicants, function being the hash of the list before
+	the delta. The graph saved for it is loaded and changed into the
+	graph of the list, which is consumed. A prime implicant which does
+	not intersect a cube removed is still prime; the others are
+	dropped, and their part outside of the cubes removed and the cubes
+	added are closed with the primes kept by close_by_consensus, where
+	only the primes kept intersecting a prime dropped are paired again.
+	When the graph links every intersecting pair, the primes kept keep
+	their links and the new primes and the dont care nodes are linked
+	to the graph; otherwise the whole list is linked again as the
+	consensus engine links it. When the file is of another function
+	or does not hold all the prime implicants, NULL is returned and
+	the list is left for the engine.
+
+	The cover saved with the graph is reused where the delta does not
+	reach. A component of intersecting primes with no new prime, no
+	prime paired again and no prime intersecting a cube added is the
+	same as in the previous run, so that the nodes of the previous
+	cover in it are a minimum cover of it.
+
+    -reuse_previous_cover is called by find_best_covering once the
+	essential prime implicants are retained. It retains these nodes,
+	known by their rank in the list covered, unless already covered;
+	the other components are covered as usual.
+
+	With -split and -cache, only the groups of outputs touched by the
+	cubes added or removed are minimized again, the others finding
+	their solution of the previous run in the cache.
+
+*********************************************************************/
+
+#include "cubes.h"
+#include <stdlib.h>
+
+static struct node
+	*removed_cubes = NULL,	/* cubes of -del, dont care at their outputs */
+	*added_cubes = NULL;	/* copy of the cubes of -add */
+
+static char *reused = NULL;	/* nodes of the previous cover, by rank */
+
+static int reused_count = 0;	/* number of nodes of the list covered */
+
+/***********************************************************************/
+
+int apply_delta(list)
+
+struct node **list;
+{
+  struct node
+	*delta,		/* cubes read in a delta file */
+	*temp_node,	/* cube of the list or of the delta */
+	*other_node,	/* cube of the delta cut from the list */
+	**previous;	/* pointer to the next node in the list */
+
+  struct cube_list
+	*pieces,	/* part of a cube left by the sharp */
+	*piece;		/* cube of the part */
+
+  int
+	nb_cut,		/* number of cubes cut */
+	nb_pieces,	/* number of cubes left of them */
+	nb_added,	/* number of cubes added */
+	count,i;
+
+  nb_cut = 0;
+  nb_pieces = 0;
+  nb_added = 0;
+  if(del_file != NULL)
+   { (void)fread_nodes(del_file,&delta);
+
+/* a cube removed is cut from the on and the dont care set of its outputs:
+   its outputs at 1 are set to dont care, which is 11.			*/
+
+     for(temp_node = delta ; temp_node != NULL ;
+	 temp_node = temp_node->next_node)
+      { temp_node->status = 0;
+	for(i = input_length ; i < total_length ; i++)
+	    temp_node->cube[i] |= (temp_node->cube[i] & mask01) << 1;
+      }
+     for(previous = list ; (temp_node = *previous) != NULL ;)
+      { pieces = NULL;
+	for(other_node = delta ; other_node != NULL ;
+	    other_node = other_node->next_node)
+	 { if(intersect(other_node->cube,temp_node->cube) == 0) continue;
+	   other_node->status = 1;
+	   if(pieces == NULL)
+		pieces = copy_and_alloc_cube_list(temp_node->cube);
+	   if(disjoint_sharp(&pieces,other_node->cube)) break;
+	 }
+	if(other_node == NULL && pieces == NULL)
+	 { previous = &temp_node->next_node;
+	   continue;
+	 }
+
+/* the cube is replaced by the cubes left of it */
+
+	nb_cut++;
+	*previous = temp_node->next_node;
+	free_node(temp_node);
+	for(piece = pieces ; piece != NULL ; piece = piece->next_cube)
+	 { temp_node = copy_and_alloc_node(piece->cube);
+	   temp_node->next_node = *previous;
+	   *previous = temp_node;
+	   previous = &temp_node->next_node;
+	   nb_pieces++;
+	 }
+	free_list_of_cubes(&pieces);
+      }
+     for(temp_node = delta ; temp_node != NULL ;
+	 temp_node = temp_node->next_node)
+      { if(temp_node->status != 0) continue;
+	warning_user_error("cube to remove not found in the function");
+	foutput_cube(stderr,temp_node->cube);
+      }
+     if(load_primes_path[0] != '\0') removed_cubes = delta;
+     else free_list_of_nodes(&delta);
+   }
+
+  for(previous = list ; *previous != NULL ; previous = &(*previous)->next_node);
+  if(add_file != NULL)
+   { nb_added = fread_nodes(add_file,previous);
+     if(load_primes_path[0] != '\0')
+      { for(temp_node = *previous ; temp_node != NULL ;
+	    temp_node = temp_node->next_node)
+	 { other_node = copy_and_alloc_node(temp_node->cube);
+	   other_node->next_node = added_cubes;
+	   added_cubes = other_node;
+	 }
+      }
+   }
+
+  count = 0;
+  for(temp_node = *list ; temp_node != NULL ; temp_node = temp_node->next_node)
+	count++;
+  if(VERBOSIS)
+   { sprintf(error_buffer,"delta : %d cubes cut in %d, %d added, %d cubes",
+	     nb_cut,nb_pieces,nb_added,count);
+     send_user_message(error_buffer);
+   }
+  return(count);
+}
+
+/***********************************************************************/
+
+/* intersect_nodes tells if the cube intersects a node of the list */
+
+static int intersect_nodes(cube,list)
+
+long int *cube;
+struct node *list;
+{
+  for(; list != NULL ; list = list->next_node)
+   { if(intersect(cube,list->cube)) return(1);
+   }
+  return(0);
+}
+
+/***********************************************************************/
+
+/* free_graph frees a list of nodes with their links */
+
+static free_graph(list)
+
+struct node **list;
+{
+  struct node *temp_node;
+
+  for(temp_node = *list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { free_list_of_parents(&temp_node->ancestors);
+     free_list_of_parents(&temp_node->descendants);
+   }
+  free_list_of_nodes(list);
+}
+
+/***********************************************************************/
+
+/* drop_links removes from a list of parents the nodes with a null status */
+
+static drop_links(parent)
+
+struct parent **parent;
+{
+  struct parent *temp_parent;
+
+  while((temp_parent = *parent) != NULL)
+   { if(temp_parent->parent->status == 0)
+      { *parent = temp_parent->next_parent;
+	free_parent(temp_parent);
+      }
+     else parent = &temp_parent->next_parent;
+   }
+}
+
+/***********************************************************************/
+
+struct node *update_prime_implicants(function,list)
+
+unsigned long function;
+struct node *list;
+{
+  struct node
+	*primes,	/* graph loaded, then the prime implicants kept */
+	**primes_end,	/* where the next one goes */
+	*dropped,	/* prime implicants leaving the graph */
+	*old_dont_care,	/* dont care nodes of the graph loaded */
+	*open,		/* cubes closed with the primes kept */
+	*added,		/* prime implicants found */
+	*dont_care,	/* dont care nodes of the list */
+	*temp_node,	/* node in the lists */
+	*next_node,	/* next node in the list */
+	**cover,	/* nodes of the previous cover still present */
+	**stack;	/* nodes reached by the delta to visit */
+
+  struct cube_list
+	*pieces,	/* part of a prime dropped left by the cubes removed */
+	*piece;		/* cube of the part */
+
+  struct parent *temp_parent;	/* link followed */
+
+  int
+	graph,		/* PRIME_ALL and PRIME_LINKED of the file */
+	nb_nodes,	/* number of nodes loaded, then in the list */
+	nb_cover,	/* number of nodes of the cover */
+	nb_stack,	/* number of nodes on the stack */
+	nb_added,	/* number of new prime implicants */
+	i;
+
+  primes = load_prime_implicants(function,(struct node *)NULL,&graph);
+  if(primes == NULL) return(NULL);
+  if((graph & PRIME_ALL) == 0)
+   { warning_user_error("the prime implicants file does not hold them all");
+     free_graph(&primes);
+     return(NULL);
+   }
+  if(DISJOINT_REQUIRED) check_disjoint_input(list);
+
+/* the nodes of the previous cover have an id of 1. The dont care nodes and
+   the primes intersecting a cube removed leave the graph, with a null
+   status; the others are kept.						*/
+
+  nb_nodes = 0;
+  for(temp_node = primes ; temp_node != NULL ; temp_node = temp_node->next_node)
+	nb_nodes++;
+  cover = (struct node **)
+	calloc((unsigned)(nb_nodes + 1),sizeof(struct node *));
+  if(cover == NULL) fatal_system_error("unable to alloc the previous cover");
+  nb_cover = 0;
+  dropped = NULL;
+  old_dont_care = NULL;
+  primes_end = &primes;
+  for(temp_node = primes ; temp_node != NULL ; temp_node = next_node)
+   { next_node = temp_node->next_node;
+     if(temp_node->id != 0) cover[nb_cover++] = temp_node;
+     temp_node->id = 0;
+     if(temp_node->status & DONT_CARE)
+      { temp_node->next_node = old_dont_care;
+	old_dont_care = temp_node;
+      }
+     else if(intersect_nodes(temp_node->cube,removed_cubes))
+      { temp_node->next_node = dropped;
+	dropped = temp_node;
+      }
+     else
+      { temp_node->status = BASIC;
+	*primes_end = temp_node;
+	primes_end = &temp_node->next_node;
+	continue;
+      }
+     temp_node->status = 0;
+   }
+  *primes_end = NULL;
+
+/* the part of each prime dropped outside of the cubes removed and the
+   cubes added are closed with the primes kept, those intersecting a
+   prime dropped being paired again.					*/
+
+  open = NULL;
+  for(temp_node = dropped ; temp_node != NULL ;
+      temp_node = temp_node->next_node)
+   { pieces = copy_and_alloc_cube_list(temp_node->cube);
+     for(next_node = removed_cubes ; next_node != NULL ;
+	 next_node = next_node->next_node)
+      { if(disjoint_sharp(&pieces,next_node->cube)) break;
+      }
+     for(piece = pieces ; piece != NULL ; piece = piece->next_cube)
+      { next_node = copy_and_alloc_node(piece->cube);
+	next_node->next_node = open;
+	open = next_node;
+      }
+     free_list_of_cubes(&pieces);
+   }
+  for(temp_node = primes ; temp_node != NULL ; temp_node = temp_node->next_node)
+	temp_node->id = intersect_nodes(temp_node->cube,dropped);
+  open = merge_node_lists(open,added_cubes);
+  added = close_by_consensus(primes,open);
+
+/* the nodes reached by the delta are the new primes, the primes paired
+   again and those intersecting a cube added; they are placed on the
+   stack.								*/
+
+  nb_added = 0;
+  for(temp_node = added ; temp_node != NULL ; temp_node = temp_node->next_node)
+	nb_added++;
+  stack = (struct node **)
+	calloc((unsigned)(nb_nodes + nb_added + 1),sizeof(struct node *));
+  if(stack == NULL) fatal_system_error("unable to alloc the previous cover");
+  nb_stack = 0;
+  for(temp_node = primes ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { if(temp_node->status == 0) continue;
+     if(temp_node->id != 0 || intersect_nodes(temp_node->cube,added_cubes))
+	stack[nb_stack++] = temp_node;
+   }
+  for(temp_node = added ; temp_node != NULL ; temp_node = temp_node->next_node)
+	stack[nb_stack++] = temp_node;
+  free_list_of_nodes(&open);
+  added_cubes = NULL;
+  free_list_of_nodes(&removed_cubes);
+
+/* the primes absorbed by a new one leave the graph as well, with the
+   links to the nodes leaving.						*/
+
+  for(primes_end = &primes ; (temp_node = *primes_end) != NULL ;)
+   { temp_node->id = 0;
+     if(temp_node->status != 0)
+      { primes_end = &temp_node->next_node;
+	continue;
+      }
+     *primes_end = temp_node->next_node;
+     temp_node->next_node = dropped;
+     dropped = temp_node;
+   }
+  for(i = 0 ; i < nb_cover ;)
+   { if(cover[i]->status == 0) cover[i] = cover[--nb_cover];
+     else i++;
+   }
+  for(temp_node = primes ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { if(graph & PRIME_LINKED)
+      { drop_links(&temp_node->ancestors);
+	drop_links(&temp_node->descendants);
+      }
+     else
+      { free_list_of_parents(&temp_node->ancestors);
+	free_list_of_parents(&temp_node->descendants);
+      }
+   }
+  free_graph(&dropped);
+  free_graph(&old_dont_care);
+
+/* the dont care nodes of the list are made as prime_implicants_by_consensus
+   makes them, and the new nodes are linked.				*/
+
+  dont_care = NULL;
+  for(temp_node = list ; temp_node != NULL ; temp_node = next_node)
+   { next_node = temp_node->next_node;
+     if(empty_output(temp_node->cube) == 0 &&
+	detect_dont_care(temp_node->cube))
+      { temp_node->next_node = dont_care;
+	dont_care = temp_node;
+	remove_do_care(temp_node->cube);
+	temp_node->status = DONT_CARE;
+	continue;
+      }
+     free_node(temp_node);
+   }
+  if(graph & PRIME_LINKED)
+   { list = merge_node_lists(primes,merge_node_lists(added,dont_care));
+     if(added != NULL) link_added_nodes(list,added);
+     else if(dont_care != NULL) link_added_nodes(list,dont_care);
+   }
+  else
+   { list = merge_node_lists(dont_care,merge_node_lists(primes,added));
+     link_prime_list(list);
+   }
+
+/* the components of intersecting primes reached by the delta are marked
+   with an id of 1, the nodes of the cover out of them are reused.	*/
+
+  for(i = 0 ; i < nb_stack ; i++) stack[i]->id = 1;
+  while(nb_stack > 0)
+   { temp_node = stack[--nb_stack];
+     for(temp_parent = temp_node->ancestors ; temp_parent != NULL ;
+	 temp_parent = temp_parent->next_parent)
+      { next_node = temp_parent->parent;
+	if(next_node->id != 0 || (next_node->status & DONT_CARE)) continue;
+	next_node->id = 1;
+	stack[nb_stack++] = next_node;
+      }
+     for(temp_parent = temp_node->descendants ; temp_parent != NULL ;
+	 temp_parent = temp_parent->next_parent)
+      { next_node = temp_parent->parent;
+	if(next_node->id != 0 || (next_node->status & DONT_CARE)) continue;
+	next_node->id = 1;
+	stack[nb_stack++] = next_node;
+      }
+   }
+  for(i = 0 ; i < nb_cover ; i++)
+   { if(cover[i]->id == 0) cover[i]->id = 2;
+   }
+
+  nb_nodes = 0;
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+	nb_nodes++;
+  if(reused != NULL) free((char *)reused);
+  reused = (char *)calloc((unsigned)(nb_nodes + 1),sizeof(char));
+  if(reused == NULL) fatal_system_error("unable to alloc the previous cover");
+  reused_count = nb_nodes;
+  nb_stack = 0;
+  nb_nodes = 0;
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { if(temp_node->id == 2) nb_stack++;
+     reused[nb_nodes++] = temp_node->id == 2;
+     temp_node->id = 0;
+   }
+  free((char *)cover);
+  free((char *)stack);
+
+  if(VERBOSIS)
+   { sprintf(error_buffer,
+	     "%d new prime implicants, %d nodes of the previous cover reused",
+	     nb_added,nb_stack);
+     send_user_message(error_buffer);
+   }
+  return(list);
+}
+
+/***********************************************************************/
+
+reuse_previous_cover(list)
+
+struct node *list;
+{
+  int rank,count;
+
+  if(reused == NULL || reused_count != prime_count) return;
+  count = 0;
+  for(rank = 0 ; list != NULL ; list = list->next_node, rank++)
+   { if(reused[rank] == 0 || (list->status & (COVERED | DECIDED))) continue;
+     scanned_node = list;
+     scanned_cube = NULL;
+     retain_node();
+     count++;
+   }
+
+  sprintf(error_buffer,"%d nodes retained from the previous cover",count);
+  if(VERBOSIS)send_user_dtime(error_buffer);
+  send_file_dtime(error_buffer);
+}
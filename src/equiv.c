@@ -0,0 +1,394 @@
+/*********************************************************************
+
+NAME
+	verify_cover
+
+PURPOSE
+	Check that the solution found is equivalent to the function read,
+	without the algorithms that found it, so that a result can be
+	trusted without simulating it again.
+
+SYNOPSIS
+	int verify_cover(function,first,end)
+	struct node *function;
+	struct node **first, **end;
+
+DESCRIPTION
+	The cubes of the solution, from first to end in a vector of nodes,
+	must cover the 1 of the function, except where the function has a
+	dont care, and must not cover a 0 of the function. The function
+	is a list of nodes as read, with its dont care. The number of
+	errors found is returned, 0 when the solution is equivalent, and
+	a message telling the result is left in error_buffer.
+
+	When the function has at most VERIFY_BIT_INPUTS inputs, each
+	output is evaluated on all the minterms, 64 at a time in an
+	unsigned long: the inputs of the lowest order select a bit of the
+	word and the others select the word. Each cube is placed in the
+	bit vectors of the 1, of the dont care and of the solution by a
+	mask on the word and the words of its subcube only; a word of the
+	solution is then compared with the function with three logical
+	operations.
+
+	With more inputs the check is done on cubes. The part of each cube
+	of the function at 1 is sharped by the cubes of the solution and
+	by the dont care of the function, and each cube of the solution is
+	sharped by the function with its dont care changed to 1; what
+	remains is an error. The sharps are done in a sharp_arena, as for
+	the essential prime implicants.
+
+	When compiled with PARALLEL and more than one job is allowed with
+	-j, the outputs, or the cubes checked, are shared among max_jobs
+	threads, output or cube i going to thread i modulo max_jobs.
+
+*********************************************************************/
+
+#include "cubes.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef PARALLEL
+#include <pthread.h>
+#endif
+
+#define VERIFY_BIT_INPUTS 20	/* most inputs checked on the minterms */
+
+struct cube_block
+ { unsigned long pattern;	/* minterms of the cube in a word */
+   long fixed;			/* inputs selecting the word, set in the cube */
+   long value;			/* value of the inputs set */
+ };
+
+struct verify_job
+ { int first;			/* first output or cube checked */
+   int step;			/* distance between two checked */
+   int errors;			/* errors found by the job */
+   int first_error;		/* first output or cube in error, or -1 */
+ };
+
+static long int
+	*on_cubes,		/* the 1 of the function */
+	*dc_cubes,		/* the dont care of the function, set to 1 */
+	*full_cubes,		/* the function with dont care set to 1 */
+	*solution_cubes;	/* the cubes of the solution */
+
+static int
+	function_count,		/* number of cubes of the function */
+	dc_count,		/* number of cubes with a dont care */
+	solution_count,		/* number of cubes in the solution */
+	word_inputs,		/* inputs selecting a bit in a word */
+	word_count;		/* words of minterms for an output */
+
+static struct cube_block
+	*function_blocks,	/* minterms of the cubes of the function */
+	*solution_blocks;	/* minterms of the cubes of the solution */
+
+/***********************************************************************/
+
+/* cube_block finds the minterms of the input part of a cube */
+
+static cube_block(cube,block)
+
+long int *cube;
+struct cube_block *block;
+{
+  unsigned long bit;
+
+  int var,code,m;
+
+  block->pattern = 0;
+  for(m = 0 ; m < 1 << word_inputs ; m++) block->pattern |= 1UL << m;
+  block->fixed = 0;
+  block->value = 0;
+  for(var = 0 ; var < input_number ; var++)
+   { code = extract_var(cube,var);
+     if(code == _X_) continue;
+     if(var < word_inputs)
+      { bit = 0;
+	for(m = 0 ; m < 1 << word_inputs ; m++)
+	 { if(m >> var & 1) bit |= 1UL << m;
+	 }
+	if(code == _0_) block->pattern &= ~bit;
+	else block->pattern &= bit;
+      }
+     else
+      { block->fixed |= 1L << (var - word_inputs);
+	if(code == _1_) block->value |= 1L << (var - word_inputs);
+      }
+   }
+}
+
+/***********************************************************************/
+
+/* place_block adds the minterms of a cube in a vector of words */
+
+static place_block(block,words)
+
+struct cube_block *block;
+unsigned long *words;
+{
+  long free_inputs,subset;
+
+  free_inputs = ~block->fixed & (word_count - 1);
+  subset = 0;
+  do
+   { words[block->value | subset] |= block->pattern;
+     subset = (subset - free_inputs) & free_inputs;
+   } while(subset != 0);
+}
+
+/***********************************************************************/
+
+/* count_bits returns the number of bits set in a word */
+
+static int count_bits(word)
+
+unsigned long word;
+{
+  int count;
+
+  for(count = 0 ; word != 0 ; count++) word &= word - 1;
+  return(count);
+}
+
+/***********************************************************************/
+
+/* output_worker compares the minterms of the function and of the solution
+   for the outputs of the job.						*/
+
+static char *output_worker(job)
+
+struct verify_job *job;
+{
+  unsigned long *on,*dc,*solution,wrong;
+
+  int output,var,i,k,errors;
+
+  on = (unsigned long *)calloc((unsigned)(3 * word_count),
+			       sizeof(unsigned long));
+  if(on == NULL) fatal_system_error("unable to alloc verification minterms");
+  dc = on + word_count;
+  solution = dc + word_count;
+
+  for(output = job->first ; output < output_number ; output += job->step)
+   { memset((char *)on,0,3 * word_count * sizeof(unsigned long));
+     var = input_length * var_per_word + output;
+     for(i = 0 ; i < function_count ; i++)
+      { if(extract_var(on_cubes + i * total_length,var))
+	   place_block(function_blocks + i,on);
+	if(extract_var(full_cubes + i * total_length,var) &&
+	   extract_var(on_cubes + i * total_length,var) == 0)
+	   place_block(function_blocks + i,dc);
+      }
+     for(i = 0 ; i < solution_count ; i++)
+      { if(extract_var(solution_cubes + i * total_length,var))
+	   place_block(solution_blocks + i,solution);
+      }
+     errors = 0;
+     for(k = 0 ; k < word_count ; k++)
+      { wrong = (on[k] ^ solution[k]) & ~dc[k];
+	if(wrong) errors += count_bits(wrong);
+      }
+     if(errors && job->first_error < 0) job->first_error = output;
+     job->errors += errors;
+   }
+  free((char *)on);
+  return(NULL);
+}
+
+/***********************************************************************/
+
+/* cube_worker sharps the cubes of the job, numbered first the cubes of
+   the function then the cubes of the solution.				*/
+
+static char *cube_worker(job)
+
+struct verify_job *job;
+{
+  struct sharp_arena arena;
+
+  long int *cube;
+
+  int i,j,covered;
+
+  arena.cube[0] = arena.cube[1] = NULL;
+  arena.size[0] = arena.size[1] = 0;
+#ifdef COUNTERS
+  arena.splits = 0;
+#endif
+  for(i = job->first ; i < function_count + solution_count ; i += job->step)
+   { arena.side = 0;
+     arena.count[0] = 0;
+     covered = 0;
+     if(i < function_count)
+      { cube = on_cubes + i * total_length;
+	if(empty_output(cube)) continue;
+	copy_cube(cube,arena_push(&arena,0));
+	for(j = 0 ; j < solution_count && covered == 0 ; j++)
+	   covered = arena_sharp(&arena,solution_cubes + j * total_length);
+	for(j = 0 ; j < dc_count && covered == 0 ; j++)
+	   covered = arena_sharp(&arena,dc_cubes + j * total_length);
+      }
+     else
+      { copy_cube(solution_cubes + (i - function_count) * total_length,
+		  arena_push(&arena,0));
+	for(j = 0 ; j < function_count && covered == 0 ; j++)
+	   covered = arena_sharp(&arena,full_cubes + j * total_length);
+      }
+     if(covered) continue;
+     if(job->first_error < 0) job->first_error = i;
+     job->errors++;
+   }
+  if(arena.cube[0] != NULL) free((char *)arena.cube[0]);
+  if(arena.cube[1] != NULL) free((char *)arena.cube[1]);
+  return(NULL);
+}
+
+/***********************************************************************/
+
+/* run_jobs shares the outputs or the cubes among the threads and returns
+   the errors found, with the first output or cube in error.		*/
+
+static int run_jobs(worker,count,first_error)
+
+char *(*worker)();
+int count,*first_error;
+{
+  struct verify_job job;	/* the job done by this thread */
+
+  int errors;
+
+#ifdef PARALLEL
+  struct verify_job *jobs;	/* the job of each thread */
+
+  pthread_t *threads;
+
+  int i,nb_threads;
+
+  nb_threads = max_jobs < count ? max_jobs : count;
+  if(nb_threads > 1)
+   { jobs = (struct verify_job *)
+		calloc((unsigned)nb_threads,sizeof(struct verify_job));
+     threads = (pthread_t *)calloc((unsigned)nb_threads,sizeof(pthread_t));
+     if(jobs == NULL || threads == NULL)
+	fatal_system_error("unable to alloc verification jobs");
+     for(i = 0 ; i < nb_threads ; i++)
+      { jobs[i].first = i;
+	jobs[i].step = nb_threads;
+	jobs[i].first_error = -1;
+	if(pthread_create(threads + i,NULL,(void *(*)())worker,
+			  (void *)(jobs + i)) != 0)
+	    fatal_system_error("unable to create a verification thread");
+      }
+     errors = 0;
+     *first_error = -1;
+     for(i = 0 ; i < nb_threads ; i++)
+      { pthread_join(threads[i],NULL);
+	errors += jobs[i].errors;
+	if(jobs[i].first_error >= 0 &&
+	   (*first_error < 0 || jobs[i].first_error < *first_error))
+	   *first_error = jobs[i].first_error;
+      }
+     free((char *)jobs);
+     free((char *)threads);
+     return(errors);
+   }
+#endif
+
+  job.first = 0;
+  job.step = 1;
+  job.errors = 0;
+  job.first_error = -1;
+  (void)(*worker)(&job);
+  *first_error = job.first_error;
+  return(job.errors);
+}
+
+/***********************************************************************/
+
+int verify_cover(function,first,end)
+
+struct node *function, **first, **end;
+{
+  struct node *temp_node, **cursor;
+
+  long int *cube;
+
+  int i,errors,first_error;
+
+/* the cubes are copied in vectors, the 1, the dont care and the whole
+   function apart, so that the threads only read them.			*/
+
+  function_count = 0;
+  for(temp_node = function ; temp_node != NULL ;
+      temp_node = temp_node->next_node) function_count++;
+  solution_count = end - first;
+  on_cubes = (long int *)calloc((unsigned)(3 * function_count +
+	solution_count + 1) * total_length,sizeof(long int));
+  if(on_cubes == NULL) fatal_system_error("unable to alloc verification");
+  dc_cubes = on_cubes + function_count * total_length;
+  full_cubes = dc_cubes + function_count * total_length;
+  solution_cubes = full_cubes + function_count * total_length;
+
+  dc_count = 0;
+  for(i = 0, temp_node = function ; temp_node != NULL ;
+      i++, temp_node = temp_node->next_node)
+   { copy_cube(temp_node->cube,on_cubes + i * total_length);
+     remove_dont_care(on_cubes + i * total_length);
+     copy_cube(temp_node->cube,full_cubes + i * total_length);
+     change_dont_to_do_care(full_cubes + i * total_length);
+     if(detect_dont_care(temp_node->cube))
+      { cube = dc_cubes + dc_count++ * total_length;
+	copy_cube(temp_node->cube,cube);
+	remove_do_care(cube);
+	change_dont_to_do_care(cube);
+      }
+   }
+  for(i = 0, cursor = first ; cursor < end ; i++, cursor++)
+   { copy_cube((*cursor)->cube,solution_cubes + i * total_length);
+     change_dont_to_do_care(solution_cubes + i * total_length);
+   }
+
+  if(input_number <= VERIFY_BIT_INPUTS)
+   { word_inputs = 0;
+     while(1 << (word_inputs + 1) <= 8 * (int)sizeof(unsigned long) &&
+	   word_inputs < input_number) word_inputs++;
+     word_count = 1 << (input_number - word_inputs);
+     function_blocks = (struct cube_block *)calloc((unsigned)(function_count
+		+ solution_count + 1),sizeof(struct cube_block));
+     if(function_blocks == NULL)
+	fatal_system_error("unable to alloc verification blocks");
+     solution_blocks = function_blocks + function_count;
+     for(i = 0 ; i < function_count ; i++)
+	cube_block(full_cubes + i * total_length,function_blocks + i);
+     for(i = 0 ; i < solution_count ; i++)
+	cube_block(solution_cubes + i * total_length,solution_blocks + i);
+     errors = run_jobs(output_worker,output_number,&first_error);
+     free((char *)function_blocks);
+     if(errors)
+      { sprintf(error_buffer,
+	"verification : %d minterms wrong, the first at output %d",
+	errors,first_error);
+      }
+   }
+  else
+   { errors = run_jobs(cube_worker,function_count + solution_count,
+		       &first_error);
+     if(errors && first_error < function_count)
+      { sprintf(error_buffer,
+	"verification : %d cubes wrong, cube %d of the function not covered",
+	errors,first_error + 1);
+      }
+     else if(errors)
+      { sprintf(error_buffer,
+	"verification : %d cubes wrong, cube %d of the solution not in it",
+	errors,first_error - function_count + 1);
+      }
+   }
+  if(errors == 0)
+   { sprintf(error_buffer,
+	     "verification : the solution is equivalent to the function");
+   }
+  free((char *)on_cubes);
+  return(errors);
+}
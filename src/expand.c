@@ -0,0 +1,170 @@
+/*********************************************************************
+
+NAME
+	prime_implicants_by_expansion
+
+PURPOSE
+	When the prime implicant generation is stopped by the memory
+	budget, a cover must still be produced with little memory. Each
+	cube of the function is expanded into one large implicant and the
+	covering is done on these implicants only.
+
+SYNOPSIS
+	struct node *prime_implicants_by_expansion(list)
+	struct node *list;
+
+DESCRIPTION
+	The cubes received, with their dont care at 1, form the cover of
+	the ON and dont care sets. Each cube not already contained in an
+	implicant kept is expanded: every input literal, in order, is
+	raised to x and every output at 0 is raised to 1 when the cube
+	stays contained in the cover. The containment is verified by
+	disjoint sharp of the cover from the cube. The implicants kept
+	absorb the ones they contain.
+
+	The implicants are prime for the order of expansion but only a few
+	of the prime implicants of the function are found, so the cover
+	selected among them is valid but not minimum.
+
+	The dont care part of the cubes is placed in separate DONT_CARE
+	nodes and the nodes are linked together by link_prime_list, as
+	the other engines do. The list received is consumed; the list
+	returned contains the dont care nodes followed by the implicants.
+
+*********************************************************************/
+
+#include "cubes.h"
+
+static struct cube_list *cover;	/* the cubes with their dont care at 1 */
+
+/***********************************************************************/
+
+/* in_cover tells if the cube is contained in the cover */
+
+static int in_cover(cube)
+
+long int *cube;
+{
+  struct cube_list
+	*remainder,		/* part of the cube not yet covered */
+	*temp_cube;		/* cube of the cover */
+
+  remainder = copy_and_alloc_cube_list(cube);
+  for(temp_cube = cover ; temp_cube != NULL ; temp_cube = temp_cube->next_cube)
+   { if(disjoint_sharp(&remainder,temp_cube->cube)) return(1);
+   }
+  free_list_of_cubes(&remainder);
+  return(0);
+}
+
+/***********************************************************************/
+
+/* expand_cube raises the literals of the cube of spare_node while it stays
+   in the cover.							*/
+
+static expand_cube()
+
+{
+  int i,var,code;
+
+  for(i = 0 ; i < input_number ; i++)
+   { if((code = extract_var(spare_node->cube,i)) == _X_) continue;
+     define_current_var(i);
+     set_current_var(spare_node->cube,mask11);
+     if(!in_cover(spare_node->cube))
+	set_current_var(spare_node->cube,code == _1_ ? mask01 : mask10);
+   }
+
+  for(i = 0 ; i < output_number ; i++)
+   { var = input_length * var_per_word + i;
+     if(extract_var(spare_node->cube,var) != 0) continue;
+     define_current_var(var);
+     set_current_var(spare_node->cube,mask01);
+     if(!in_cover(spare_node->cube)) set_current_var(spare_node->cube,mask00);
+   }
+}
+
+/***********************************************************************/
+
+struct node
+*prime_implicants_by_expansion(list)
+
+struct node *list;
+{
+  struct node
+	*temp_node,	/* node in the list */
+	*next_node,	/* next node in the list */
+	**previous,	/* pointer to the implicant examined */
+	*dont_care,	/* nodes of the dont care cover */
+	*prime_list;	/* implicants found */
+
+  struct cube_list *temp_cube;
+
+  int expanded;		/* number of cubes expanded */
+
+  cover = NULL;
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { if(empty_output(temp_node->cube)) continue;
+     temp_cube = copy_and_alloc_cube_list(temp_node->cube);
+     change_dont_to_do_care(temp_cube->cube);
+     temp_cube->next_cube = cover;
+     cover = temp_cube;
+   }
+
+/* each cube not contained in an implicant kept is expanded, the implicant
+   obtained replaces the ones it contains.				*/
+
+  prime_list = NULL;
+  expanded = 0;
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { PROGRESS();
+     if(empty_output(temp_node->cube)) continue;
+     copy_cube(temp_node->cube,spare_node->cube);
+     change_dont_to_do_care(spare_node->cube);
+     for(next_node = prime_list ; next_node != NULL ;
+	 next_node = next_node->next_node)
+      { if(covers(next_node->cube,spare_node->cube)) break;
+      }
+     if(next_node != NULL) continue;
+
+     expand_cube();
+     expanded++;
+     for(previous = &prime_list ; (next_node = *previous) != NULL ;)
+      { if(covers(spare_node->cube,next_node->cube))
+	 { *previous = next_node->next_node;
+	   free_node(next_node);
+	 }
+	else previous = &next_node->next_node;
+      }
+     next_node = copy_and_alloc_node(spare_node->cube);
+     next_node->status = BASIC;
+     next_node->next_node = prime_list;
+     prime_list = next_node;
+   }
+  free_list_of_cubes(&cover);
+
+  if(VERBOSIS)
+   { sprintf(error_buffer,"expansion heuristic : %d cubes expanded",expanded);
+     send_user_message(error_buffer);
+   }
+
+/* the dont care part of the cubes is kept in dont care nodes, the other
+   nodes are released.							*/
+
+  dont_care = NULL;
+  for(temp_node = list ; temp_node != NULL ; temp_node = next_node)
+   { next_node = temp_node->next_node;
+     if(empty_output(temp_node->cube) == 0 && detect_dont_care(temp_node->cube))
+      { temp_node->next_node = dont_care;
+	dont_care = temp_node;
+	remove_do_care(temp_node->cube);
+	temp_node->status = DONT_CARE;
+	continue;
+      }
+     free_node(temp_node);
+   }
+
+  list = merge_node_lists(dont_care,prime_list);
+  link_prime_list(list);
+  return(list);
+}
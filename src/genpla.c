@@ -0,0 +1,191 @@
+/*********************************************************************
+
+NAME
+	genpla
+
+PURPOSE
+	The examples shipped are too small to measure the program. This
+	program generates families of functions whose size grows with a
+	parameter, to benchmark McBOOLE on functions of known structure.
+
+SYNOPSIS
+	genpla adder n
+	genpla mult n
+	genpla parity n
+	genpla comp n
+	genpla cyclic n
+	genpla random inputs outputs cubes [x-density [dc-ratio [seed]]]
+
+DESCRIPTION
+	The function is written on the standard output in the input format
+	of McBOOLE, preceded by a comment telling how it was generated.
+	Only the cubes asserting an output are written.
+
+     adder n	the sum of two n bit numbers, 2n inputs and n+1 outputs.
+
+     mult n	the product of two n bit numbers, 2n inputs and 2n outputs.
+
+     parity n	the parity of n inputs, 1 output; no two minterms can be
+		merged and all of them are essential.
+
+     comp n	the comparison of two n bit numbers, 2n inputs and the
+		3 outputs less, equal and greater.
+
+     cyclic n	all the minterms of n inputs except 0...0 and 1...1, a
+		cyclic covering core without essential prime implicant.
+
+     random	cubes with each input at x with probability x-density (0.3
+		by default) and each output at dont care with probability
+		dc-ratio (0.1 by default), otherwise at 1 or 0 with equal
+		probability. The same seed (1 by default) gives the same
+		function.
+
+	The functions given by a truth table are limited to 20 inputs.
+
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_TABLE_INPUTS 20	/* biggest truth table generated */
+
+static unsigned long random_state;	/* state of the random generator */
+
+/***********************************************************************/
+
+/* next_random returns a number between 0 and 1 with a linear congruential
+   generator, to get the same functions on all the systems.		*/
+
+static double next_random()
+
+{
+  random_state = (random_state * 1103515245UL + 12345UL) & 0x7fffffffUL;
+  return((double)random_state / 2147483648.0);
+}
+
+/***********************************************************************/
+
+static usage()
+
+{
+  fprintf(stderr,"usage: genpla adder|mult|parity|comp|cyclic n\n");
+  fprintf(stderr,
+     "       genpla random inputs outputs cubes [x-density [dc-ratio [seed]]]\n");
+  exit(1);
+}
+
+/***********************************************************************/
+
+/* put_bits writes the nb low bits of value, the most significant first */
+
+static put_bits(value,nb)
+
+unsigned long value;
+int nb;
+{
+  for(nb-- ; nb >= 0 ; nb--) putchar((value >> nb) & 1 ? '1' : '0');
+}
+
+/***********************************************************************/
+
+/* truth_table writes the minterms of the family asserting an output */
+
+static truth_table(family,n)
+
+char *family;
+int n;
+{
+  unsigned long
+	minterm,	/* inputs of the row */
+	a,b,		/* the two numbers of the inputs */
+	result,		/* outputs of the row */
+	mask;		/* n low bits */
+
+  int inputs,outputs;
+
+  inputs = strcmp(family,"parity") == 0 || strcmp(family,"cyclic") == 0 ?
+	   n : 2 * n;
+  if(inputs > MAX_TABLE_INPUTS) usage();
+  outputs = 1;
+  if(strcmp(family,"adder") == 0) outputs = n + 1;
+  else if(strcmp(family,"mult") == 0) outputs = 2 * n;
+  else if(strcmp(family,"comp") == 0) outputs = 3;
+
+  printf("/* genpla %s %d : %d inputs %d outputs */\n",family,n,inputs,outputs);
+  mask = (1UL << n) - 1;
+  for(minterm = 0 ; minterm < (1UL << inputs) ; minterm++)
+   { a = (minterm >> n) & mask;
+     b = minterm & mask;
+     if(strcmp(family,"adder") == 0) result = a + b;
+     else if(strcmp(family,"mult") == 0) result = a * b;
+     else if(strcmp(family,"comp") == 0) result = a < b ? 4 : a == b ? 2 : 1;
+     else if(strcmp(family,"parity") == 0)
+      { for(result = 0, a = minterm ; a != 0 ; a &= a - 1) result ^= 1;
+      }
+     else result = minterm != 0 && minterm != (1UL << inputs) - 1;
+     if(result == 0) continue;
+     put_bits(minterm,inputs);
+     putchar(' ');
+     put_bits(result,outputs);
+     putchar('\n');
+   }
+}
+
+/***********************************************************************/
+
+/* random_pla writes cubes drawn at random */
+
+static random_pla(inputs,outputs,cubes,x_density,dc_ratio)
+
+int inputs,outputs,cubes;
+double x_density,dc_ratio;
+{
+  double q;
+
+  int i,j,asserted;
+
+  printf("/* genpla random %d %d %d %g %g %lu */\n",inputs,outputs,cubes,
+	 x_density,dc_ratio,random_state);
+  for(i = 0 ; i < cubes ; i++)
+   { for(j = 0 ; j < inputs ; j++)
+      { if(next_random() < x_density) putchar('x');
+	else putchar(next_random() < 0.5 ? '0' : '1');
+      }
+     putchar(' ');
+     asserted = 0;
+     for(j = 0 ; j < outputs ; j++)
+      { q = next_random();
+	if(q < dc_ratio) putchar('d');
+	else if(q < dc_ratio + (1.0 - dc_ratio) / 2 ||
+		(j == outputs - 1 && asserted == 0))
+	 { putchar('1');
+	   asserted = 1;
+	 }
+	else putchar('0');
+      }
+     putchar('\n');
+   }
+}
+
+/***********************************************************************/
+
+main(argc,argv)
+
+int argc;
+char **argv;
+{
+  if(argc < 3) usage();
+  if(strcmp(argv[1],"random") == 0)
+   { if(argc < 5) usage();
+     random_state = argc > 7 ? strtoul(argv[7],(char **)NULL,10) : 1;
+     random_pla(atoi(argv[2]),atoi(argv[3]),atoi(argv[4]),
+		argc > 5 ? atof(argv[5]) : 0.3,argc > 6 ? atof(argv[6]) : 0.1);
+   }
+  else if(strcmp(argv[1],"adder") == 0 || strcmp(argv[1],"mult") == 0 ||
+	  strcmp(argv[1],"parity") == 0 || strcmp(argv[1],"comp") == 0 ||
+	  strcmp(argv[1],"cyclic") == 0)
+	truth_table(argv[1],atoi(argv[2]));
+  else usage();
+  exit(0);
+}
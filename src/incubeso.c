@@ -43,6 +43,7 @@ long int *cube1,*cube2,*result_cube;
 
   int common_output;
 
+  COUNT(COUNT_STAR_CALL);
   merged_word = cube1 + current_word_index;
   end_input = cube1 + input_length;
   end_output = cube1 + total_length;
@@ -88,7 +89,10 @@ long int *cube1,*cube2,*result_cube;
      cube2++;
      result_cube++;
    }
-  if(common_output) return(1);
+  if(common_output)
+   { COUNT(COUNT_STAR_MERGE);
+     return(1);
+   }
   else return(0);
 }
 
@@ -141,6 +145,7 @@ long int *cube1,*cube2;
 {
   long int *end_of_cube; /* pointer to the word after the last of cube*/
 
+  COUNT(COUNT_COVERS);
   end_of_cube = cube1 + total_length;
 
   for(; cube1 < end_of_cube ; cube1++)
@@ -185,6 +190,7 @@ long int *cube1,*cube2;
 	cube1_covers,	/* logic variable tells if 1 covers 2 up to now */
 	cube2_covers;	/* logic variable tells if 2 covers 1 up to now */
 
+  COUNT(COUNT_ABSORB);
   end_of_cube = cube1 + total_length;
 
   cube1_covers = 1;
@@ -289,7 +295,8 @@ long int *cube;
 struct cube_list *list;
 {
   for(; list != NULL ; list = list->next_cube)
-   { if(intersect(cube,list->cube)) return(1);
+   { COUNT(COUNT_INTERSECT_VISIT);
+     if(intersect(cube,list->cube)) return(1);
    }
   return(0);
 }
@@ -389,7 +396,8 @@ struct cube_list **list;
 	with the sharping cube will be reset to 0 as a result of the sharp
 	operation.							*/
 
-               { temp_pointer = present_cube_list->next_cube;
+               { COUNT(COUNT_SHARP_SPLIT);
+		 temp_pointer = present_cube_list->next_cube;
                  present_cube_list->next_cube =
 		 copy_and_alloc_cube_list(present_cube_list->cube);
 
@@ -29,6 +29,17 @@ DESCRIPTION
      -b maximum branching depth allowed. If the cycles have a greater depth,
 	the user will be warned and a heuristic solution will be taken.
 
+     -branch rule choosing the node to branch on in a cycle: affect, the
+	  node affecting the most undecided nodes (default), minterm, the
+	  node leaving the most minterms uncovered, constrained, the node
+	  covered by the fewest alternatives, cost, affect weighted by the
+	  cost of the node, or random, affect with ties broken at random.
+	  With time each rule is run on the function and the one giving
+	  the smallest solution, then the fastest, is used. With portfolio
+	  -j workers, one per rule when -j is 1, cover the function at the
+	  same time with different rules and random seeds; the first to
+	  find a minimum solution stops the others.
+
      -rit input terminator of cubes in the input file. It is : by default.
 
      -rot output terminator of cubes in the input file. It is ; by default
@@ -39,6 +50,87 @@ DESCRIPTION
 
      -nint when set, intersecting cubes at input will not be accepted.
 
+     -eng engine used to generate the prime implicants: part for the
+	  recursive partitioning (default), cons for the iterated consensus,
+	  often faster with many outputs and few inputs, or zdd for the
+	  implicit generation with decision diagrams, useful when the number
+	  of prime implicants is very large. With auto the engine is chosen
+	  from statistics on the cubes read and with time all the engines
+	  are timed on the function and the fastest is used.
+
+     -calib file of samples for the automatic engine selection. With
+	  -eng time, the statistics of the function and the fastest engine
+	  are appended to it; with -eng auto, its samples are used with
+	  the built in ones.
+
+     -split when set, the outputs are divided in groups which do not
+	  interact and each group is minimized separately.
+
+     -j   number of processes minimizing the groups of outputs at the same
+	  time, of threads looking for the essential prime implicants and
+	  of workers with -branch portfolio, 1 by default.
+
+     -stats file receiving, in JSON, the wall clock and cpu time of each
+	  phase, the peak memory and the size of the function and solution
+	  (default extension .json).
+
+     -mem memory budget in Mbytes. When it is reached the branching stops
+	  and a heuristic solution is taken; when it is reached while the
+	  prime implicants are generated, the cubes are only expanded into
+	  a few implicants and the solution is not minimum.
+
+     -trace file receiving a binary record of each decision taken on a
+	  cycle by the covering (default extension .trc), summarized by
+	  tracesum.
+
+     -cache directory keeping the solutions found, shared by the runs. When
+	  the function read, in any order, was already minimized with the
+	  same -min, -nint, -b, -branch and -eng, its solution is taken
+	  from the directory, whose name is at most 400 characters.
+
+     -cachesize size of the cache directory in Mbytes, 64 by default; the
+	  solutions used the least recently are removed beyond it.
+
+     -add file of cubes added to the function read (default extension .in).
+
+     -del file of cubes removed from the function read, cut by disjoint
+	  sharp from its on and dont care sets for the outputs where they
+	  have a 1 or a dont care. With -load-primes, the prime implicants
+	  and the cover saved for the function before -add and -del are
+	  only changed where the cubes reach them; with -split and -cache,
+	  only the groups of outputs changed are minimized again.
+
+     -serve path of a Unix socket on which the program waits for functions
+	  to minimize, sent by mcclient with some switches, and sends back
+	  their solutions. -j workers serve the requests at the same time.
+
+     -save-primes file receiving the prime implicants and their graph, in
+	  binary, when they are generated or updated by -add and -del, and
+	  the cover found when it is minimum.
+
+     -load-primes file of prime implicants saved with -save-primes for the
+	  function read, or before -add and -del; they are taken from it
+	  instead of being generated.
+
+     -checkpoint file keeping the nodes retained by the covering once they
+	  are final, before any branching and after each partition of the
+	  first depth, at most each -checkperiod seconds, 60 by default.
+	  It is removed at the end of the run.
+
+     -resume when set, the covering starts from the nodes kept in the file
+	  -checkpoint by a run of the same function that did not finish.
+
+     -progress when set, a line telling the phase, the nodes allocated,
+	  decided and undecided, the branching depth and the resident
+	  memory is printed on stderr each second.
+
+     -status file rewritten each second with the same information in
+	  JSON, for a program following the run.
+
+     -verify when set, the solution is checked against the function read,
+	  on all the minterms for up to 20 inputs and by disjoint sharp
+	  above; the program exits with status 1 when it is not equivalent.
+
      -min when set, the program will minimize not only the number of product
 	  terms but will also give the minimal number of literals at input.
 	  This costs however some additional cpu time.
@@ -63,8 +155,11 @@ AUTHOR
 #include <stdio.h>
 #include "cubes.h"
 #include "param.h"
+#include <stdlib.h>
+#include <string.h>
 
-FILE *input_file, *output_file;
+FILE *input_file, *output_file, *stats_file = NULL, *trace_file = NULL,
+     *add_file = NULL, *del_file = NULL;
 
 int 
 	EPI_LIST,		/* tells if we should list the epi cubes */
@@ -72,6 +167,15 @@ int
 	VERBOSIS = 0,		/* puts the program in verbose mode */
 	VERY_VERBOSIS = 0,	/* puts it more verbose */
 	DONT_MIN_LITERAL = 1,	/* minimize only the number of product terms */
+	SPLIT_OUTPUTS = 0,	/* minimize each group of outputs separately */
+	PROGRESS_LINE = 0,	/* print the progress each second */
+	VERIFY_COVER = 0,	/* check the solution against the function */
+	RESUME_COVERING = 0,	/* resume the covering from the checkpoint */
+	checkpoint_period = 60,	/* seconds between two checkpoints */
+	max_jobs = 1,		/* processes working at the same time */
+	memory_limit = 0,	/* memory budget in Mbytes, 0 for none */
+	cache_size = 64,	/* size of the cache in Mbytes */
+	stats_cubes,		/* number of cubes read */
 	max_branching_depth,	/* maximum branching depth reached */
 	depth_limit = 10;	/* maximum branching depth allowed */
 
@@ -79,23 +183,44 @@ char
 	read_interminator = ' ',	/* input terminator for cubes at input*/
 	read_outterminator = '\n',	/* output terminator of cubes at input*/
 	*print_interminator = " ",	/* input terminator for output file */
-	*print_outterminator = "\n";	/* output terminator for output file */
+	*print_outterminator = "\n",	/* output terminator for output file */
+	*prime_engine = "part",		/* prime implicant generation engine */
+	*calib_file = "",		/* samples for the engine selection */
+	*status_path = "",		/* file receiving the progress */
+	*cache_dir = "",		/* directory of the solutions kept */
+	*serve_path = "",		/* socket of the server mode */
+	*checkpoint_path = "",		/* checkpoint of the covering */
+	*save_primes_path = "",		/* file receiving the prime implicants */
+	*load_primes_path = "",		/* file giving the prime implicants */
+	*branch_rule = "affect";	/* rule choosing the branching node */
 
 struct p_file
 	p1 = {"in","r",&input_file},
-	p2 = {"out","w",&output_file};
+	p2 = {"out","w",&output_file},
+	p16 = {"json","w",&stats_file},
+	p20 = {"trc","w",&trace_file},
+	p25 = {"in","r",&add_file},
+	p26 = {"in","r",&del_file};
 
 struct p_2file
 	p3 = {"in","r","out","w",&input_file,&output_file};
 
 struct p_integer
-	p4 = {0,16,&depth_limit};
+	p4 = {0,16,&depth_limit},
+	p14 = {1,256,&max_jobs},
+	p17 = {0,1048576,&memory_limit},
+	p23 = {1,1048576,&cache_size},
+	p28 = {0,1000000,&checkpoint_period};
 
 struct p_logical
 	p5 = {&DISJOINT_REQUIRED},
 	p6 = {&VERBOSIS},
 	p6a = {&VERY_VERBOSIS},
 	p7 = {&DONT_MIN_LITERAL},
+	p15 = {&SPLIT_OUTPUTS},
+	p18 = {&PROGRESS_LINE},
+	p21 = {&VERIFY_COVER},
+	p29 = {&RESUME_COVERING},
 	p100 = {&EPI_LIST};
 
 struct p_character
@@ -104,7 +229,16 @@ struct p_character
 
 struct p_string
 	p10 = {1,10,&print_interminator},
-	p11 = {1,10,&print_outterminator};
+	p11 = {1,10,&print_outterminator},
+	p12 = {1,10,&prime_engine},
+	p13 = {1,128,&calib_file},
+	p19 = {1,128,&status_path},
+	p22 = {1,256,&cache_dir},
+	p24 = {1,100,&serve_path},
+	p27 = {1,256,&checkpoint_path},
+	p30 = {1,256,&save_primes_path},
+	p31 = {1,256,&load_primes_path},
+	p32 = {1,16,&branch_rule};
 
 struct parameter parmv[]
    = { "rit","input terminator read",P_CHARACTER,0,0,P_OPTIONAL,(char *)&p8,
@@ -112,15 +246,43 @@ struct parameter parmv[]
        "pit","input terminator print",P_STRING,0,0,P_OPTIONAL,(char *)&p10,
        "pot","output terminator print",P_STRING,0,0,P_OPTIONAL,(char *)&p11,
        "nint","intersection not accepted",P_LOGICAL,0,0,P_OPTIONAL,(char *)&p5,
+       "verify","check the solution",P_LOGICAL,0,0,P_OPTIONAL,(char *)&p21,
        "vv","very verbose mode",P_LOGICAL,0,0,P_OPTIONAL,(char *)&p6a,
        "v","verbose mode",P_LOGICAL,0,0,P_OPTIONAL,(char *)&p6,
        "min","literal minimization",P_LOGICAL,0,0,P_OPTIONAL,(char *)&p7,
+       "add","cubes added",P_FILE,0,0,P_OPTIONAL,(char *)&p25,
+       "del","cubes removed",P_FILE,0,0,P_OPTIONAL,(char *)&p26,
        "io","input and output",P_2FILE,9,10,P_PRESENT_A_EXCL + P_PRESENT_B_EXCL,
 				(char *)&p3,
 	"i","input",P_FILE,0,0,P_OPTIONAL + P_DEFAULT,(char *)&p1,
 	"o","output",P_FILE,0,0,P_OPTIONAL + P_DEFAULT,(char *)&p2,
+	"branch","branching rule",P_STRING,0,0,P_OPTIONAL,(char *)&p32,
 	"b","branching depth",P_INTEGER,0,0,P_OPTIONAL,(char *)&p4,
 	"n","non disjoint cubes",P_LOGICAL,0,0,P_OPTIONAL,(char *)&p5,
+	"eng","prime generation engine",P_STRING,0,0,P_OPTIONAL,(char *)&p12,
+	"save-primes","prime implicants file written",P_STRING,0,0,P_OPTIONAL,
+				(char *)&p30,
+	"load-primes","prime implicants file read",P_STRING,0,0,P_OPTIONAL,
+				(char *)&p31,
+	"serve","serve requests on a socket",P_STRING,0,0,P_OPTIONAL,
+				(char *)&p24,
+	"split","split the outputs in components",P_LOGICAL,0,0,P_OPTIONAL,
+				(char *)&p15,
+	"j","parallel jobs",P_INTEGER,0,0,P_OPTIONAL,(char *)&p14,
+	"stats","statistics file",P_FILE,0,0,P_OPTIONAL,(char *)&p16,
+	"mem","memory budget",P_INTEGER,0,0,P_OPTIONAL,(char *)&p17,
+	"trace","branching trace file",P_FILE,0,0,P_OPTIONAL,(char *)&p20,
+	"progress","progress each second",P_LOGICAL,0,0,P_OPTIONAL,(char *)&p18,
+	"status","progress status file",P_STRING,0,0,P_OPTIONAL,(char *)&p19,
+	"cachesize","cache size",P_INTEGER,0,0,P_OPTIONAL,(char *)&p23,
+	"cache","solution cache directory",P_STRING,0,0,P_OPTIONAL,(char *)&p22,
+	"checkperiod","seconds between checkpoints",P_INTEGER,0,0,P_OPTIONAL,
+				(char *)&p28,
+	"checkpoint","covering checkpoint file",P_STRING,0,0,P_OPTIONAL,
+				(char *)&p27,
+	"resume","resume from the checkpoint",P_LOGICAL,0,0,P_OPTIONAL,
+				(char *)&p29,
+	"calib","engine calibration file",P_STRING,0,0,P_OPTIONAL,(char *)&p13,
 	"epi","list the epi cubes",P_LOGICAL,0,0,P_OPTIONAL,(char *)&p100};
 
 int parmc = sizeof(parmv) / sizeof(struct parameter);
@@ -130,15 +292,6 @@ main(argc,argv)
 int argc;
 char **argv;
 {
-  struct node 
-	*temp_node,	/* temp pointer in the list */
-	*list;		/* list of nodes to minimize */
-
-  int 
-	nb_nodes,		/* number of nodes read */ 
-	input_literal,		/* number of literal at input */
-	output_literal;		/* number of literal at output */
-
   /* set file descriptor associations */
   input_file = stdin;
   output_file = stdout;
@@ -148,8 +301,68 @@ char **argv;
 
   param(parmc,parmv,argc,argv);
   if(VERY_VERBOSIS) VERBOSIS = 1;
+  set_branch_rule(branch_rule);
+  if(SPLIT_OUTPUTS && checkpoint_path[0] != '\0')
+   { warning_user_error("-checkpoint is not used with -split");
+     checkpoint_path = "";
+   }
+  if(SPLIT_OUTPUTS && (save_primes_path[0] != '\0' ||
+			load_primes_path[0] != '\0'))
+   { warning_user_error("-save-primes and -load-primes are not used with -split");
+     save_primes_path = load_primes_path = "";
+   }
+  if(RESUME_COVERING && checkpoint_path[0] == '\0')
+	fatal_user_error("-resume needs the file given with -checkpoint");
+  if(strlen(cache_dir) > CACHE_DIR_SIZE)
+	fatal_user_error("the name of the -cache directory is too long");
+
+/* With -serve the functions come from the socket, each is minimized by
+   a process forked from a worker as below.				*/
+
+  if(serve_path[0] != '\0') serve_requests();
+  minimize();
+  exit(0);
+}
 
+/***********************************************************************/
+
+/* minimize reads the function on input_file and writes its solution on
+   output_file, with the switches set.					*/
+
+minimize()
+
+{
+  struct node 
+	*temp_node,	/* temp pointer in the list */
+	*list,		/* list of nodes to minimize */
+	*function,	/* copy of the nodes read, for the verification */
+	**function_end,	/* where the next copy goes */
+	*primes;	/* prime implicants linked in a graph */
+
+  unsigned long
+	key,		/* hash of the function for -save-primes */
+	previous;	/* hash of the function before -add and -del */
+
+  char cache_path[CACHE_PATH_SIZE];	/* file of the solution in the cache */
+
+  int 
+	cached,			/* the solution was found in the cache */
+	save,			/* the graph is written in -save-primes */
+	verify_errors,		/* errors found in the solution */
+	nb_nodes,		/* number of nodes read */ 
+	input_literal,		/* number of literal at input */
+	output_literal;		/* number of literal at output */
+
+  start_progress();
+
+  profile_begin(PHASE_READ);
   (void)fread_nodes(input_file,&list);
+  previous = 0;
+  if(add_file != NULL || del_file != NULL)
+   { if(load_primes_path[0] != '\0') previous = function_hash(list);
+     (void)apply_delta(&list);
+   }
+  profile_end(PHASE_READ);
 
 /* We will compute the number of literal in the initial solution.  */
 
@@ -162,32 +375,111 @@ char **argv;
      input_literal += input_cost(temp_node->cube);
      output_literal += output_cost(temp_node->cube);
    }
+  stats_cubes = nb_nodes;
   sprintf(error_buffer,"%d nodes, var : in %d out %d literal : in %d out %d",
 	     nb_nodes,input_number,output_number,input_literal,output_literal);
   if(VERBOSIS)send_user_dtime(error_buffer);
   send_file_dtime(error_buffer);
 
-/* We will find the prime implicants */
+/* The nodes read are modified by the minimization, a copy is kept when the
+   solution will be verified.						*/
+
+  function = NULL;
+  if(VERIFY_COVER)
+   { function_end = &function;
+     for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+      { *function_end = copy_and_alloc_node(temp_node->cube);
+	function_end = &(*function_end)->next_node;
+      }
+     *function_end = NULL;
+   }
 
-  list = prime_implicants_by_recursive_partitioning(list);
+/* We will find the prime implicants, for the whole function or for each
+   group of outputs which do not interact, unless the solution was kept
+   in the cache.							*/
+
+  cached = cache_fetch(list,cache_path);
+  if(cached)
+   { free_list_of_nodes(&list);
+     sprintf(error_buffer,"The solution found in the cache contains %d nodes",
+	     (int)(retained_nodes - prime_nodes));
+     if(VERBOSIS)send_user_dtime(error_buffer);
+     send_file_dtime(error_buffer);
+   }
+  else if(SPLIT_OUTPUTS)
+   { profile_begin(PHASE_SPLIT);
+     minimize_by_output_components(list);
+     profile_end(PHASE_SPLIT);
+   }
+  else
+   { profile_begin(PHASE_PRIME);
+
+/* with a delta, the graph saved for the function before it is updated;
+   the graph generated or updated is saved, with the cover found.	*/
+
+     key = function_hash(list);
+     save = save_primes_path[0] != '\0';
+     primes = NULL;
+     if(load_primes_path[0] != '\0' && (add_file != NULL || del_file != NULL))
+      { primes = update_prime_implicants(previous,list);
+	if(primes != NULL) prime_graph = PRIME_ALL | PRIME_LINKED;
+      }
+     else if(load_primes_path[0] != '\0')
+      { primes = load_prime_implicants(key,list,(int *)NULL);
+	if(primes != NULL) save = 0;
+      }
+     if(primes == NULL) primes = generate_prime_implicants(prime_engine,list);
+     if(save && (memory_exceeded & MEMORY_CUT))
+      { warning_user_error("prime implicants reduced, not saved");
+	save = 0;
+      }
+     if(save) save_prime_implicants(key,prime_graph,primes);
+     list = primes;
+     profile_end(PHASE_PRIME);
 
 /* We will select a set of prime implicants to cover the function. The
    function will also give some information on the number of prime implicants,
    the number of essential implicants and so on when the verbose mode is
    activated.							           */
 
-  find_best_covering(list);
+     find_best_covering(list);
+     if(save) save_prime_cover();
+   }
 
 /* The final solution is in the vector Prime_nodes which is an external
    variable. The nodes retained are in the beginning of the vector and
    go up to the pointer Retained_nodes.					*/
 
+  profile_begin(PHASE_WRITE);
   foutput_node_vector(output_file,prime_nodes,retained_nodes);
+  profile_end(PHASE_WRITE);
+
+  verify_errors = 0;
+  if(VERIFY_COVER)
+   { profile_begin(PHASE_VERIFY);
+     verify_errors = verify_cover(function,prime_nodes,retained_nodes);
+     profile_end(PHASE_VERIFY);
+     if(VERBOSIS || verify_errors)send_user_dtime(error_buffer);
+     send_file_dtime(error_buffer);
+     free_list_of_nodes(&function);
+   }
+  if(cached == 0 && memory_exceeded == 0 && verify_errors == 0)
+	cache_store(cache_path);
 
 /* The program is finished, we print the total CPU time elapsed and the 
    maximum branching depth reached.					*/
 
-  if(max_branching_depth < INFINITY)
+  if(memory_exceeded & MEMORY_CUT)
+   { sprintf(error_buffer,
+     "memory budget reached : %d Mbytes, prime implicants reduced, not minimum",
+     memory_limit);
+   }
+  else if(memory_exceeded && max_branching_depth >= INFINITY)
+   { sprintf(error_buffer,
+     "memory budget reached : %d Mbytes, best solution not garanteed",
+     memory_limit);
+   }
+  else if(max_branching_depth < INFINITY)
    { sprintf(error_buffer,"end, max branching depth reached : %d",
 	     max_branching_depth);
    }
@@ -197,5 +489,33 @@ char **argv;
    }
   if(VERBOSIS)send_user_etime(error_buffer);
   send_file_etime(error_buffer);
+  stop_progress();
+  close_trace();
+  profile_report();
+  if(verify_errors) exit(1);
 }
 
+
+/***********************************************************************/
+
+/* quiet_child is called by a child process forked to work for this one,
+   so that it writes none of the files of the parent: the output file is
+   /dev/null and the status, trace, statistics and checkpoint files are
+   not written. Unless messages is set, the messages and the progress
+   line are turned off as well.						*/
+
+quiet_child(messages)
+
+int messages;
+{
+  output_file = fopen("/dev/null","w");
+  if(output_file == NULL) fatal_system_error("unable to open /dev/null");
+  status_path = "";
+  trace_file = NULL;
+  stats_file = NULL;
+  checkpoint_path = "";
+  if(messages) return;
+  VERBOSIS = 0;
+  VERY_VERBOSIS = 0;
+  PROGRESS_LINE = 0;
+}
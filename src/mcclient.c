@@ -0,0 +1,124 @@
+/*********************************************************************
+
+NAME
+	mcclient
+
+PURPOSE
+	Send a function to McBOOLE running with -serve and get its
+	solution, as a run of the program would give it.
+
+SYNOPSIS
+	mcclient socket [switches] < input > output
+
+DESCRIPTION
+	The switches, among -min, -nint, -n, -b, -eng, -mem, -verify and
+	-split, are sent on the request line, followed by the cubes read on
+	stdin. The output file of the server is written on stdout and the
+	program exits with the status of the request: 0 when the function
+	was minimized, 1 for instance when it is wrong or the verification
+	failed, the messages being then written on stderr, and 3 when the
+	server cannot be reached.
+
+*********************************************************************/
+
+#define _XOPEN_SOURCE 700
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/***********************************************************************/
+
+static int write_all(fd,buffer,length)
+
+int fd;
+char *buffer;
+long length;
+{
+  long done;
+
+  while(length > 0)
+   { done = write(fd,buffer,(size_t)length);
+     if(done < 0 && errno == EINTR) continue;
+     if(done <= 0) return(0);
+     buffer += done;
+     length -= done;
+   }
+  return(1);
+}
+
+/***********************************************************************/
+
+main(argc,argv)
+
+int argc;
+char **argv;
+{
+  struct sockaddr_un address;
+
+  FILE *response;
+
+  char buffer[8192];
+
+  long length;
+
+  int fd,i,status;
+
+  if(argc < 2)
+   { fprintf(stderr,"usage: mcclient socket [switches] < input > output\n");
+     exit(3);
+   }
+  fd = socket(AF_UNIX,SOCK_STREAM,0);
+  memset((char *)&address,0,sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path,argv[1],sizeof(address.sun_path) - 1);
+  if(fd < 0 ||
+     connect(fd,(struct sockaddr *)&address,sizeof(address)) != 0)
+   { perror(argv[1]);
+     exit(3);
+   }
+
+/* the request line, then the cubes up to the end of stdin */
+
+  strcpy(buffer,"MCBOOLE 1");
+  for(i = 2 ; i < argc ; i++)
+   { if(strlen(buffer) + strlen(argv[i]) + 2 >= sizeof(buffer))
+      { fprintf(stderr,"mcclient: too many switches\n");
+	exit(3);
+      }
+     strcat(buffer," ");
+     strcat(buffer,argv[i]);
+   }
+  strcat(buffer,"\n");
+  if(write_all(fd,buffer,(long)strlen(buffer)) == 0)
+   { perror("mcclient");
+     exit(3);
+   }
+  while((length = read(0,buffer,sizeof(buffer))) > 0)
+   { if(write_all(fd,buffer,length) == 0)
+      { perror("mcclient");
+	exit(3);
+      }
+   }
+  shutdown(fd,SHUT_WR);
+
+/* the status line, then the output file */
+
+  response = fdopen(fd,"r");
+  if(response == NULL || fscanf(response,"STATUS %d %ld",&status,&length) != 2
+     || getc(response) != '\n')
+   { fprintf(stderr,"mcclient: no response from the server\n");
+     exit(3);
+   }
+  while(length > 0 && (i = fread(buffer,1,length < sizeof(buffer) ?
+				 (size_t)length : sizeof(buffer),response)) > 0)
+   { fwrite(buffer,1,(size_t)i,status == 0 ? stdout : stderr);
+     length -= i;
+   }
+  exit(status);
+}
@@ -194,8 +194,8 @@ struct node *node;
 {
   struct parent *temp_parent;
 
-  fprintf(fp,"address : %lu, status : %d, count %lu, ",node,node->status,
-							node->count);
+  fprintf(fp,"address : %lu, status : %d, id %d, ",node,node->status,
+							node->id);
   foutput_cube(fp,node->cube);
   foutput_cube_list(fp,node->uncovered); 
   fprintf(fp,"ancestors : ");
@@ -0,0 +1,459 @@
+/*********************************************************************
+
+NAME
+	minimize_by_output_components
+
+PURPOSE
+	Many multiple output functions are made of groups of outputs that
+	do not interact. Each group can be minimized alone, on fewer cubes
+	and a smaller graph, and the groups can be minimized in parallel.
+
+SYNOPSIS
+	minimize_by_output_components(list)
+	struct node *list;
+
+DESCRIPTION
+	Two outputs interact when a cube asserts both of them, with a 1 or
+	a dont care, or when two cubes asserting them intersect at input.
+	The connected components of this relation are found with a union
+	find on the outputs. Outputs of different components have disjoint
+	covers, so no product term can be shared between them and the
+	union of the minimum covers of the components is a minimum cover
+	of the function.
+
+	For each component, the cubes asserting one of its outputs are
+	copied with the other outputs at 0, the prime implicants are
+	generated by the engine selected and find_best_covering is called.
+	The cubes retained are collected and, at the end, placed in the
+	vector prime_nodes up to retained_nodes as find_best_covering does,
+	in the order of the components. When the components are minimized
+	in this process, the graph of each one is freed once its cubes
+	retained are copied.
+
+	With -cache, the solution of each component is kept in the cache
+	under the key of its cubes. A component whose cubes did not change
+	since a previous run, when a few cubes were added or removed with
+	-add and -del for instance, takes its solution from the cache and
+	only the components changed are minimized.
+
+	When compiled with PARALLEL and more than one job is allowed with
+	-j, each component is minimized in a child process which sends the
+	cubes retained through a pipe; up to max_jobs children run at the
+	same time. The list received is consumed.
+
+*********************************************************************/
+
+#ifdef PARALLEL
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "cubes.h"
+#include <stdlib.h>
+
+#ifdef PARALLEL
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+static int *component;		/* union find parent of each output */
+
+static struct node *solution;	/* cubes retained in all the components */
+
+static int
+	solution_count,		/* number of cubes in the solution */
+	cached_count,		/* components found in the cache */
+	total_primes,		/* prime implicants of all the components */
+	deepest_branching;	/* deepest branching in all the components */
+
+/***********************************************************************/
+
+static int find_component(output)
+
+int output;
+{
+  int root;
+
+  for(root = output ; component[root] != root ; root = component[root]);
+  while(component[output] != root)
+   { output = component[output];
+     component[output] = root;
+   }
+  return(root);
+}
+
+/***********************************************************************/
+
+static join_components(output1,output2)
+
+int output1,output2;
+{
+  output1 = find_component(output1);
+  output2 = find_component(output2);
+  if(output1 < output2) component[output2] = output1;
+  else component[output1] = output2;
+}
+
+/***********************************************************************/
+
+/* first_output returns the first output asserted by a cube, -1 if none */
+
+static int first_output(cube)
+
+long int *cube;
+{
+  int i;
+
+  for(i = 0 ; i < output_number ; i++)
+   { if(extract_var(cube,input_length * var_per_word + i) & _1_) return(i);
+   }
+  return(-1);
+}
+
+/***********************************************************************/
+
+/* input_intersect tells if the input parts of two cubes intersect */
+
+static int input_intersect(cube1,cube2)
+
+long int *cube1,*cube2;
+{
+  long int result;
+
+  int i;
+
+  for(i = 0 ; i < input_length ; i++)
+   { result = cube1[i] & cube2[i];
+     if((((result << 1) | result) & mask10) != mask10) return(0);
+   }
+  return(1);
+}
+
+/***********************************************************************/
+
+/* join_pair joins the components of two cubes intersecting at input; the
+   id of each cube holds its first output during the pass.		*/
+
+static join_pair(node1,node2)
+
+struct node *node1,*node2;
+{
+  if(find_component(node1->id) != find_component(node2->id) &&
+     input_intersect(node1->cube,node2->cube))
+	join_components(node1->id,node2->id);
+}
+
+/***********************************************************************/
+
+/* component_list returns copies of the cubes of list asserting an output
+   of the component root, with the outputs of other components at 0.  */
+
+static struct node *component_list(list,root)
+
+struct node *list;
+int root;
+{
+  struct node *copy_list,*temp_node;
+
+  int i;
+
+  copy_list = NULL;
+  for(; list != NULL ; list = list->next_node)
+   { copy_cube(list->cube,spare_node->cube);
+     for(i = 0 ; i < output_number ; i++)
+      { if(find_component(i) != root)
+	 { define_current_var(input_length * var_per_word + i);
+	   set_current_var(spare_node->cube,mask00);
+	 }
+      }
+     if(first_output(spare_node->cube) < 0) continue;
+     temp_node = copy_and_alloc_node(spare_node->cube);
+     temp_node->next_node = copy_list;
+     copy_list = temp_node;
+   }
+  return(copy_list);
+}
+
+/***********************************************************************/
+
+/* add_to_solution copies a cube retained at the end of the solution */
+
+static struct node **solution_end;	/* where the next cube goes */
+
+static add_to_solution(cube)
+
+long int *cube;
+{
+  struct node *temp_node;
+
+  temp_node = copy_and_alloc_node(cube);
+  temp_node->next_node = NULL;
+  *solution_end = temp_node;
+  solution_end = &temp_node->next_node;
+  solution_count++;
+}
+
+/***********************************************************************/
+
+/* minimize_component minimizes the cubes of one component in this
+   process, or takes its solution from the cache.			*/
+
+static minimize_component(list)
+
+struct node *list;
+{
+  char path[CACHE_PATH_SIZE];	/* file of the component in the cache */
+
+  if(cache_fetch(list,path))
+   { free_list_of_nodes(&list);
+     cached_count++;
+   }
+  else
+   { profile_begin(PHASE_PRIME);
+     list = generate_prime_implicants(prime_engine,list);
+     profile_end(PHASE_PRIME);
+     find_best_covering(list);
+     if(memory_exceeded == 0) cache_store(path);
+   }
+  total_primes += prime_count;
+  if(max_branching_depth > deepest_branching)
+	deepest_branching = max_branching_depth;
+}
+
+/***********************************************************************/
+
+#ifdef PARALLEL
+
+/* start_component forks a child minimizing the component; the child
+   writes the depth reached, the number of prime implicants, whether the
+   memory budget was reached and the solution was in the cache, the
+   number of cubes and the cubes retained on a pipe. The descriptor to
+   read is returned and the pid of the child is placed in pid.	*/
+
+static int start_component(list,pid)
+
+struct node *list;
+pid_t *pid;
+{
+  struct node **cursor;
+
+  int fd[2],count;
+
+  fflush(stdout);
+  fflush(stderr);
+  fflush(output_file);
+  if(pipe(fd) < 0) fatal_system_error("unable to create a pipe");
+  switch(*pid = fork())
+   { case -1 :
+	fatal_system_error("unable to fork a component");
+
+     case 0 :
+	close(fd[0]);
+	quiet_child(1);
+	cached_count = 0;
+	start_progress();
+	minimize_component(list);
+	count = retained_nodes - prime_nodes;
+	(void)write(fd[1],(char *)&max_branching_depth,sizeof(int));
+	(void)write(fd[1],(char *)&prime_count,sizeof(int));
+	(void)write(fd[1],(char *)&memory_exceeded,sizeof(int));
+	(void)write(fd[1],(char *)&cached_count,sizeof(int));
+	(void)write(fd[1],(char *)&count,sizeof(int));
+	for(cursor = prime_nodes ; cursor < retained_nodes ; cursor++)
+	 { (void)write(fd[1],(char *)(*cursor)->cube,
+			(unsigned)total_length * sizeof(long int));
+	 }
+	_exit(0);
+   }
+  close(fd[1]);
+  free_list_of_nodes(&list);
+  return(fd[0]);
+}
+
+/***********************************************************************/
+
+static int read_fully(fd,buffer,size)
+
+int fd,size;
+char *buffer;
+{
+  int done,n;
+
+  for(done = 0 ; done < size ; done += n)
+   { n = read(fd,buffer + done,(unsigned)(size - done));
+     if(n <= 0) return(0);
+   }
+  return(1);
+}
+
+/***********************************************************************/
+
+/* finish_component reads what the child pid sent on fd, adds it to the
+   solution and waits for the child.					*/
+
+static finish_component(fd,pid)
+
+int fd;
+pid_t pid;
+{
+  int depth,primes,exceeded,cached,count;
+
+  if(!read_fully(fd,(char *)&depth,sizeof(int)) ||
+     !read_fully(fd,(char *)&primes,sizeof(int)) ||
+     !read_fully(fd,(char *)&exceeded,sizeof(int)) ||
+     !read_fully(fd,(char *)&cached,sizeof(int)) ||
+     !read_fully(fd,(char *)&count,sizeof(int)))
+	fatal_system_error("a component process failed");
+  if(depth > deepest_branching) deepest_branching = depth;
+  total_primes += primes;
+  memory_exceeded |= exceeded;
+  cached_count += cached;
+  for(; count > 0 ; count--)
+   { if(!read_fully(fd,(char *)spare_node->cube,
+		(int)(total_length * sizeof(long int))))
+	fatal_system_error("a component process failed");
+     add_to_solution(spare_node->cube);
+   }
+  close(fd);
+  (void)waitpid(pid,(int *)NULL,0);
+}
+
+#endif
+
+/***********************************************************************/
+
+minimize_by_output_components(list)
+
+struct node *list;
+{
+  struct node
+	*temp_node,	/* cube of the list */
+	**asserting,	/* cubes asserting an output */
+	**cursor;	/* pointer in the prime nodes vector */
+
+  int
+	*root,		/* root of each component with cubes */
+	nb_components,	/* number of components */
+	nb_asserting,	/* number of cubes asserting an output */
+	i,first;
+
+#ifdef PARALLEL
+  int
+	*pipe_fd,	/* descriptor to read each component */
+	next_to_read;	/* first component not read yet */
+
+  pid_t *child;		/* process minimizing each component */
+#endif
+
+  component = (int *)calloc((unsigned)output_number,sizeof(int));
+  root = (int *)calloc((unsigned)output_number,sizeof(int));
+  if(component == NULL || root == NULL)
+	fatal_system_error("unable to alloc output components");
+  for(i = 0 ; i < output_number ; i++) component[i] = i;
+
+/* the outputs asserted by each cube and by the cubes intersecting it are
+   placed in the same component. The pairs of cubes are found by
+   pair_within, which skips the pairs with a 0 and a 1 for an input as
+   link_prime_list does.						*/
+
+  nb_asserting = 0;
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+	nb_asserting++;
+  asserting = (struct node **)
+	calloc((unsigned)(nb_asserting + 1),sizeof(struct node *));
+  if(asserting == NULL)
+	fatal_system_error("unable to alloc output components");
+  nb_asserting = 0;
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { if((first = first_output(temp_node->cube)) < 0) continue;
+     for(i = first + 1 ; i < output_number ; i++)
+      { if(extract_var(temp_node->cube,input_length * var_per_word + i) & _1_)
+	    join_components(first,i);
+      }
+     temp_node->id = first;
+     asserting[nb_asserting++] = temp_node;
+   }
+  pair_within(asserting,nb_asserting,join_pair);
+  free((char *)asserting);
+
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { if((first = first_output(temp_node->cube)) >= 0)
+	root[find_component(first)] = 1;
+   }
+  nb_components = 0;
+  for(i = 0 ; i < output_number ; i++)
+   { if(root[i]) root[nb_components++] = i;
+   }
+
+  if(VERBOSIS)
+   { sprintf(error_buffer,"%d independent output components",nb_components);
+     send_user_message(error_buffer);
+   }
+
+/* each component is minimized, in a child process when allowed, and the
+   cubes retained are added to the solution in the order of the
+   components.								*/
+
+  solution = NULL;
+  solution_end = &solution;
+  solution_count = 0;
+  total_primes = 0;
+  deepest_branching = 0;
+  cached_count = 0;
+
+#ifdef PARALLEL
+  if(max_jobs > 1 && nb_components > 1)
+   { pipe_fd = (int *)calloc((unsigned)nb_components,sizeof(int));
+     child = (pid_t *)calloc((unsigned)nb_components,sizeof(pid_t));
+     if(pipe_fd == NULL || child == NULL)
+	fatal_system_error("unable to alloc output components");
+     next_to_read = 0;
+     for(i = 0 ; i < nb_components ; i++)
+      { if(i - next_to_read >= max_jobs)
+	 { finish_component(pipe_fd[next_to_read],child[next_to_read]);
+	   next_to_read++;
+	 }
+	pipe_fd[i] = start_component(component_list(list,root[i]),child + i);
+      }
+     for(; next_to_read < nb_components ; next_to_read++)
+	finish_component(pipe_fd[next_to_read],child[next_to_read]);
+     free((char *)pipe_fd);
+     free((char *)child);
+   }
+  else
+#endif
+
+   { for(i = 0 ; i < nb_components ; i++)
+      { minimize_component(component_list(list,root[i]));
+	for(cursor = prime_nodes ; cursor < retained_nodes ; cursor++)
+	    add_to_solution((*cursor)->cube);
+	free_covering();
+      }
+   }
+
+/* the solution is placed in the vector as find_best_covering leaves it */
+
+  free_list_of_nodes(&list);
+  prime_nodes = (struct node **)
+	calloc((unsigned)(solution_count + 1),sizeof(struct node *));
+  if(prime_nodes == NULL) fatal_system_error("unable to allocate prime_nodes");
+  retained_nodes = prime_nodes;
+  for(temp_node = solution ; temp_node != NULL ;
+      temp_node = temp_node->next_node)
+	*(retained_nodes++) = temp_node;
+  max_branching_depth = deepest_branching;
+  prime_count = total_primes;
+
+  sprintf(error_buffer,"The solution of the %d components contains %d nodes",
+	  nb_components,solution_count);
+  if(VERBOSIS) send_user_message(error_buffer);
+  send_file_message(error_buffer);
+  if(VERBOSIS && cached_count > 0)
+   { sprintf(error_buffer,"%d components found in the cache, %d minimized",
+	     cached_count,nb_components - cached_count);
+     send_user_message(error_buffer);
+   }
+
+  free((char *)component);
+  free((char *)root);
+}
@@ -359,7 +359,7 @@ int source;
       for(; ;)
        { if(source == ASK)
           { fprintf(stdout,"%s: enter %s file name : ",argv[0],parm->descr);
-            if(fscanf(stdin,"%s",buffer) == 0)
+            if(fscanf(stdin,"%s",buffer) != 1)
 	     { fprintf(stderr,"\n%s: illegal character at input\n",argv[0]);
 	       exit(1); 
 	     }
@@ -395,7 +395,7 @@ int source;
       for(; ;)
        { if(source == ASK)
           { fprintf(stdout,"%s: enter %s file name : ",argv[0],parm->descr);
-            if(fscanf(stdin,"%s",buffer) == 0)
+            if(fscanf(stdin,"%s",buffer) != 1)
 	     { fprintf(stderr,"\n%s: illegal character at input\n",argv[0]);
 	       exit(1);
 	     }
@@ -430,9 +430,9 @@ int source;
        { if(source == ASK)
           { fprintf(stdout,
 		    "%s: enter %s integer value : ",argv[0],parm->descr);
-            if(fscanf(stdin,"%d",p3->intp) == 0)
+            if(fscanf(stdin,"%d",p3->intp) != 1)
 	     { putc('\n',stdout);
-	       if(fscanf(stdin,"%s",buffer) == 0)
+	       if(fscanf(stdin,"%s",buffer) != 1)
 		{ fprintf(stderr,"\n%s: illegal character at input\n",argv[0]);
 		  exit(1);
 		}
@@ -457,9 +457,9 @@ int source;
        { if(source == ASK)
           { fprintf(stdout,
 		    "%s: enter %s float value : ",argv[0],parm->descr);
-            if(fscanf(stdin,"%f",p4->floatp) == 0)
+            if(fscanf(stdin,"%f",p4->floatp) != 1)
 	     { putc('\n',stdout);
-	       if(fscanf(stdin,"%s",buffer) == 0)
+	       if(fscanf(stdin,"%s",buffer) != 1)
 		{ fprintf(stderr,"\n%s: illegal character at input\n",argv[0]);
 		  exit(1);
 		}
@@ -486,7 +486,7 @@ int source;
        { if(source == ASK)
           { fprintf(stdout,
   		    "%s: enter %s character string : ",argv[0],parm->descr);
-            if(fscanf(stdin,"%s",buffer) == 0)
+            if(fscanf(stdin,"%s",buffer) != 1)
 	     { fprintf(stderr,"\n%s: illegal character at input\n",argv[0]);
 	       exit(1);
 	     }
@@ -516,7 +516,7 @@ int source;
       if(source == ASK)
        { fprintf(stdout,
   		 "%s: enter %s single character : ",argv[0],parm->descr);
-         if(fscanf(stdin,"%s",buffer) == 0)
+         if(fscanf(stdin,"%s",buffer) != 1)
 	  { fprintf(stderr,"\n%s: illegal character at input\n",argv[0]);
 	    exit(1);
 	  }
@@ -1,4 +1,6 @@
 #include "cubes.h"
+#include <stdlib.h>
+#include <string.h>
 
 /****************************************************************************
 
@@ -43,6 +45,7 @@ retain_node()
   free_list_of_cubes(&scanned_cube);
   free_list_of_cubes(&(scanned_node->uncovered));
   scanned_node->status = DECIDED_RETAINED;
+  touch_node(scanned_node);
   current_node = scanned_node;
   increment_pass_count();
   scan_affected_retained_ancestors();
@@ -56,6 +59,7 @@ unretain_inferior_node()
 
 {
   scanned_node->status = DECIDED_INFERIOR;
+  touch_node(scanned_node);
   current_node = scanned_node;
   increment_pass_count();
   scan_affected_unretain_ancestors();
@@ -157,7 +161,7 @@ place_nodes_in_vector()
 /*********************************************************************
 
 NAME
-	select_node
+	select_node, init_node_scores, touch_node, set_branch_rule
 
 PURPOSE
 	This function is called to select an undecided node using some
@@ -168,15 +172,62 @@ PURPOSE
 SYNOPSIS
 	select_node()
 
+	init_node_scores()
+
+	touch_node(node)
+	struct node *node;
+
+	set_branch_rule(name)
+	char *name;
+
 DESCRIPTION
-	The function puts the node selected in scanned node. The heuristic
-	used is the following; we take the node which if retained or
+	The function puts the node selected in scanned node, the undecided
+	node of best score, the first one in the vector on a tie. The score
+	is given by the branching rule chosen with -branch:
+
+	affect, by default; we take the node which if retained or
 	unretained will affect the biggest number of direct undecided
 	parents. This way we know that if we retain  or unretain it, most 
 	probably, many nodes will be affected and get decided. We want
 	this way to break in pieces the cycles, to reduce the branching depth
 	necessary to solve completely the covering.
 
+	minterm; the node with the most minterms in its uncovered part, at
+	input and output, so that a large part of the function is settled.
+
+	constrained; the node whose uncovered part intersects the fewest
+	undecided parents, the part with the fewest alternatives.
+
+	cost; the score of affect weighted by the number of x at input, to
+	prefer the cheap nodes when the depth limit is reached.
+
+	random; the score of affect with random low order bits, so that
+	the ties are broken at random, the same at each run for the same
+	random_seed.
+
+	The score of the node selected is left in select_score.
+
+	The score of a node only changes when one of its parents gets
+	decided or has its uncovered part changed, which happens to few
+	nodes between two calls. The score of each node is kept in the
+	vector node_score, at the place of its id, and only computed again
+	when it is -1.
+
+    -init_node_scores is called by find_best_covering when the prime nodes
+	are in the vector; no score is computed yet.
+
+    -touch_node is called on each node decided, sharped or restored. The
+	node is only noted, once, in the vector touched_nodes; select_node
+	sets to -1 the score of the nodes noted and of their parents before
+	it looks for the best node. A covering without cycle thus never
+	visits the parents of the nodes changed.
+
+    -set_branch_rule makes the rule named the one used by select_node. A
+	name not in the table is a fatal error. With the rules time and
+	portfolio, the first rule is used until find_best_covering calls
+	time_branch_rules or portfolio_covering, which give the rule for
+	each function.
+
 COORDINATES
 	McGill University Electrical Engineering VLSI lab MONTREAL CANADA
 	27 july 1984
@@ -188,6 +239,214 @@ AUTHOR
 
 #define AFFECTED_SCORE 1
 #define COVERED_SCORE 4
+#define RANDOM_SCORE 64		/* range of the random part of a score */
+#define MAX_SCORE 1000000000	/* scores are kept below */
+
+int
+	select_score,		/* score of the node selected */
+	*node_score = NULL;	/* score of each node, -1 when it changed */
+
+static struct node
+	**touched_nodes = NULL;	/* nodes changed since the last selection */
+
+static char *node_touched = NULL;	/* the node is in touched_nodes */
+
+static int touched_count;	/* number of nodes in touched_nodes */
+
+static unsigned long random_state;	/* state of the random generator */
+
+unsigned long random_seed = 1;	/* first state of the random generator */
+
+static long scores_charge = 0;	/* memory charged for the vectors above */
+
+/***********************************************************************/
+
+init_node_scores()
+
+{
+  node_score = (int *)realloc((char *)node_score,
+			(unsigned)(prime_count + 1) * sizeof(int));
+  touched_nodes = (struct node **)realloc((char *)touched_nodes,
+			(unsigned)(prime_count + 1) * sizeof(struct node *));
+  node_touched = realloc(node_touched,(unsigned)(prime_count + 1));
+  if(node_score == NULL || touched_nodes == NULL || node_touched == NULL)
+	fatal_system_error("unable to allocate node scores");
+  release_memory(scores_charge);
+  scores_charge = (long)prime_count *
+		(sizeof(int) + sizeof(struct node *) + sizeof(char));
+  charge_memory(scores_charge);
+  memset((char *)node_score,0xff,(unsigned)(prime_count + 1) * sizeof(int));
+  memset(node_touched,0,(unsigned)(prime_count + 1));
+  touched_count = 0;
+  random_state = random_seed;
+}
+
+/***********************************************************************/
+
+touch_node(node)
+
+struct node *node;
+{
+  if(node_touched[node->id]) return;
+  node_touched[node->id] = 1;
+  touched_nodes[touched_count++] = node;
+}
+
+/***********************************************************************/
+
+
+/* affect_score returns the score of an undecided node for the rule affect */
+
+static int affect_score(temp_node)
+
+struct node *temp_node;
+{
+  struct parent *temp_parent;	/* pointer in the parent list of the node */
+
+  int value;			/* score of the temp_node */
+
+/* the node is undecided, we will see how many of its parents have their
+   uncovered part intersecting with it and so would be affected by any
+   decision taken on it.					*/
+
+  value = 0;
+  temp_parent = temp_node->ancestors;
+  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
+   { if(temp_parent->parent->status & DECIDED) continue;
+     if(intersect_list(temp_node->cube,temp_parent->parent->uncovered))
+      { if(covers_list(temp_node->cube,temp_parent->parent->uncovered))
+	 { value += COVERED_SCORE;
+	 }
+	else value += AFFECTED_SCORE;
+      }
+   }
+
+  temp_parent = temp_node->descendants;
+  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
+   { if(temp_parent->parent->status & DECIDED) continue; 
+     if(intersect_list(temp_node->cube,temp_parent->parent->uncovered))
+      { if(covers_list(temp_node->cube,temp_parent->parent->uncovered))
+	 { value += COVERED_SCORE;
+	 }
+	else value += AFFECTED_SCORE;
+      }
+   }
+  return(value);
+}
+
+/***********************************************************************/
+
+/* minterm_score counts the minterms of the uncovered part of the node */
+
+static int minterm_score(temp_node)
+
+struct node *temp_node;
+{
+  struct cube_list *temp_cube;	/* cube of the uncovered part */
+
+  long minterms;			/* number of minterms */
+
+  int free_inputs;		/* number of x at input of the cube */
+
+/* a cube has 2 to the number of x minterms for each 1 at output, the score
+   being kept below MAX_SCORE.						*/
+
+  minterms = 0;
+  temp_cube = temp_node->uncovered;
+  for(; temp_cube != NULL ; temp_cube = temp_cube->next_cube)
+   { free_inputs = input_number - input_cost(temp_cube->cube);
+     if(free_inputs >= 30) return(MAX_SCORE);
+     minterms += (long)output_cost(temp_cube->cube) << free_inputs;
+     if(minterms >= MAX_SCORE) return(MAX_SCORE);
+   }
+  return((int)minterms);
+}
+
+/***********************************************************************/
+
+/* constrained_score is higher when fewer undecided parents intersect the
+   uncovered part of the node.						*/
+
+static int constrained_score(temp_node)
+
+struct node *temp_node;
+{
+  struct parent *temp_parent;	/* pointer in the parent list of the node */
+
+  int alternatives;		/* parents covering a part of the node */
+
+  alternatives = 0;
+  temp_parent = temp_node->ancestors;
+  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
+   { if(temp_parent->parent->status & DECIDED) continue;
+     if(intersect_list(temp_parent->parent->cube,temp_node->uncovered))
+	alternatives++;
+   }
+  temp_parent = temp_node->descendants;
+  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
+   { if(temp_parent->parent->status & DECIDED) continue;
+     if(intersect_list(temp_parent->parent->cube,temp_node->uncovered))
+	alternatives++;
+   }
+  return(prime_count - alternatives);
+}
+
+/***********************************************************************/
+
+/* cost_score weights the score of affect by the number of x at input */
+
+static int cost_score(temp_node)
+
+struct node *temp_node;
+{
+  return(affect_score(temp_node) * (input_number + 1 - temp_node->cost));
+}
+
+/***********************************************************************/
+
+/* random_score adds random low order bits to the score of affect */
+
+static int random_score(temp_node)
+
+struct node *temp_node;
+{
+  random_state = random_state * 6364136223846793005UL + 1442695040888963407UL;
+  return(affect_score(temp_node) * RANDOM_SCORE +
+	 (int)(random_state >> 58) % RANDOM_SCORE);
+}
+
+/***********************************************************************/
+
+struct branch_entry branch_rules[] =
+ { { "affect", affect_score },
+   { "minterm", minterm_score },
+   { "constrained", constrained_score },
+   { "cost", cost_score },
+   { "random", random_score }
+ };
+
+int
+	nb_branch_rules = sizeof(branch_rules) / sizeof(struct branch_entry),
+	branch_rule_number = 0;	/* rule used by select_node */
+
+/***********************************************************************/
+
+set_branch_rule(name)
+
+char *name;
+{
+  int i;
+
+  branch_rule_number = 0;
+  if(strcmp(name,"time") == 0 || strcmp(name,"portfolio") == 0) return;
+  for(i = 0 ; i < nb_branch_rules ; i++)
+   { if(strcmp(name,branch_rules[i].name) == 0) break;
+   }
+  if(i == nb_branch_rules) fatal_user_error("unknown branching rule");
+  branch_rule_number = i;
+}
+
+/***********************************************************************/
 
 select_node()
 
@@ -202,6 +461,21 @@ select_node()
 	value,			/* score of the temp_node */
 	best_value;		/* score of scanned node, the best node */
 
+/* the nodes changed since the last call and their parents will have their
+   score computed again.						*/
+
+  for(; touched_count > 0 ;)
+   { temp_node = touched_nodes[--touched_count];
+     node_touched[temp_node->id] = 0;
+     node_score[temp_node->id] = -1;
+     temp_parent = temp_node->ancestors;
+     for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
+	node_score[temp_parent->parent->id] = -1;
+     temp_parent = temp_node->descendants;
+     for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
+	node_score[temp_parent->parent->id] = -1;
+   }
+
   best_value = -1;
   cursor = retained_nodes;
 
@@ -209,31 +483,12 @@ select_node()
    { temp_node = *cursor;
      if(temp_node->status & DECIDED) continue;
 
-/* the node is undecided, we will see how many of its parents have their
-   uncovered part intersecting with it and so would be affected by any
-   decision taken on it.					*/
+/* the score kept is used unless a parent of the node changed since */
 
-     value = 0;
-     temp_parent = temp_node->ancestors;
-     for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
-      { if(temp_parent->parent->status & DECIDED) continue;
-	if(intersect_list(temp_node->cube,temp_parent->parent->uncovered))
-         { if(covers_list(temp_node->cube,temp_parent->parent->uncovered))
-	    { value += COVERED_SCORE;
-	    }
-	   else value += AFFECTED_SCORE;
-	 }
-      }
-
-     temp_parent = temp_node->descendants;
-     for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
-      { if(temp_parent->parent->status & DECIDED) continue; 
-	if(intersect_list(temp_node->cube,temp_parent->parent->uncovered))
-         { if(covers_list(temp_node->cube,temp_parent->parent->uncovered))
-	    { value += COVERED_SCORE;
-	    }
-	   else value += AFFECTED_SCORE;
-	 }
+     value = node_score[temp_node->id];
+     if(value < 0)
+      { value = (*branch_rules[branch_rule_number].score)(temp_node);
+	node_score[temp_node->id] = value;
       }
 
      if(value > best_value)
@@ -247,6 +502,7 @@ select_node()
    itself with assertions.						*/
 
   if(best_value == -1) fatal_program_error("partition with no undecided node"); 
+  select_score = best_value;
 }
 
 /*********************************************************************
@@ -256,7 +512,7 @@ NAME
 
 PURPOSE
 	These function take care of all the operations needed by the 
-	pass count, from the initialization of the count in the nodes
+	pass count, from the initialization of the counts of the nodes
 	to the increment of the pass counter.
 
 SYNOPSIS
@@ -265,13 +521,15 @@ SYNOPSIS
 	init_pass_count()
 
 DESCRIPTION
-	When we initialize, all the nodes in the working lists get their count
+	The count of each node is not in the node but in the vector pass_mark,
+	at the place of its id, so that a scan only writes to the vector and
+	the nodes it reads stay unchanged. When we initialize, the vector is
 	reset to 0, the pass_counter is then put to 2. At any time when we
 	increment the pass_count, we want to insure that the count of all the
 	nodes is inferior to the new pass_count so the count can never reach
-	any of the values left in the nodes. There is a problem however, when
+	any of the values left in the vector. There is a problem however, when
 	the pass_count does overflow and comes back to 0; at that point, we
-	simply reinitialize all the nodes and put the pass count to 2. Also
+	simply reset the vector and put the pass count to 2. Also
 	the first node scanned, current_node, will have its count set to the
 	pass counter.
 
@@ -291,6 +549,7 @@ AUTHOR
 increment_pass_count()
 
 {
+  COUNT(COUNT_SCAN_PASS);
   pass_counter += 2;
 
 /* we have an overflow of the pass counter */
@@ -301,7 +560,7 @@ increment_pass_count()
    }
 
   odd_pass_counter = pass_counter | ONE;
-  current_node->count = pass_counter;
+  PASS_MARK(current_node) = pass_counter;
   return;
 }
 
@@ -310,13 +569,8 @@ increment_pass_count()
 init_pass_count()
 
 {
-  struct node **cursor;		/* temp pointer in the vector to reset */
-
   pass_counter = 0;
-  cursor = prime_nodes;
-  for(; cursor <  end_prime ; cursor++)
-   { (*cursor)->count = pass_counter;
-   }
+  memset((char *)pass_mark,0,(unsigned)(prime_count + 1) * sizeof(unsigned int));
 }
 
 /***********************************************************************
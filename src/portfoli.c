@@ -0,0 +1,329 @@
+/*********************************************************************
+
+NAME
+	portfolio_covering, portfolio_bound, portfolio_cut
+
+PURPOSE
+	The time taken by the covering of a function with many cycles
+	depends much on the nodes chosen for the first branchings, and no
+	branching rule is the best on all the functions. With -branch
+	portfolio, several workers cover the function at the same time,
+	each with its own rule, and the first to find a minimum solution
+	stops the others.
+
+SYNOPSIS
+	portfolio_covering(list)
+	struct node *list;
+
+	portfolio_bound()
+
+	int portfolio_cut(count)
+	int count;
+
+DESCRIPTION
+    -portfolio_covering is called by find_best_covering with the prime
+	implicants linked in a graph. It forks -j workers, or one per rule
+	when -j is 1. Worker i covers its copy of the graph with the rule
+	i modulo the number of rules; past the rules, the workers use the
+	rule random, each with its own seed. A worker sends on its pipe
+	whether its solution is minimum, the branching depth limit and the
+	memory budget not being reached, with its cost and its cubes.
+
+	The parent keeps the solution of fewest cubes, then of fewest
+	literals at input, in a board shared with the workers. The first
+	minimum solution received is the answer and the other workers are
+	killed; otherwise all the workers finish. Each worker and its
+	result are written in the output file. The solution is placed in
+	the vector prime_nodes up to retained_nodes as find_best_covering
+	leaves it.
+
+    -portfolio_bound is called by the covering where the nodes retained
+	are final, as for the checkpoint, and by the worker once its
+	covering is done. In a worker, when they are more than the cubes
+	of the best solution on the board, the worker can not do better
+	and leaves without sending anything.
+
+    -portfolio_cut tells a worker whether count nodes retained are more
+	than the cubes of the best solution on the board. The covering
+	calls it in each partition, once the side with the branching node
+	unretained is solved, with the nodes retained before the partition
+	plus the branching node: when they are more, the side with the
+	branching node retained is not solved. If that side was the better
+	one, both sides give more cubes than the board and the worker
+	leaves at portfolio_bound, so that a solution sent as minimum is
+	always one.
+
+*********************************************************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "cubes.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+struct portfolio_board
+ { int best_count;		/* cubes of the best solution received */
+   int solved;			/* a minimum solution was received */
+ };
+
+struct portfolio_result
+ { int exact;			/* the solution is minimum */
+   int depth;			/* maximum branching depth reached */
+   int exceeded;		/* memory_exceeded of the worker */
+   int count;			/* number of cubes in the solution */
+   int literals;		/* literals at input of the solution */
+ };
+
+static volatile struct portfolio_board
+	*board = NULL;		/* shared by the parent and the workers */
+
+static int in_worker = 0;	/* this process is a worker */
+
+/***********************************************************************/
+
+static int read_fully(fd,buffer,size)
+
+int fd,size;
+char *buffer;
+{
+  int done,n;
+
+  for(done = 0 ; done < size ; done += n)
+   { n = read(fd,buffer + done,(unsigned)(size - done));
+     if(n <= 0) return(0);
+   }
+  return(1);
+}
+
+/***********************************************************************/
+
+/* worker_rule returns the branching rule of worker i */
+
+static int worker_rule(i)
+
+int i;
+{
+  int rule;
+
+  if(i < nb_branch_rules) return(i);
+  for(rule = 0 ; rule < nb_branch_rules - 1 ; rule++)
+   { if(strcmp(branch_rules[rule].name,"random") == 0) break;
+   }
+  return(rule);
+}
+
+/***********************************************************************/
+
+/* run_worker covers the list with the rule of worker i and sends the
+   solution on fd.							*/
+
+static run_worker(list,i,fd)
+
+struct node *list;
+int i,fd;
+{
+  struct portfolio_result result;
+
+  struct node **cursor;
+
+  in_worker = 1;
+  quiet_child(0);
+  max_jobs = 1;
+  branch_rule_number = worker_rule(i);
+  random_seed = i + 1;
+  branch_rule = branch_rules[branch_rule_number].name;
+  find_best_covering(list);
+  portfolio_bound();
+
+  result.depth = max_branching_depth;
+  result.exceeded = memory_exceeded;
+  result.exact = max_branching_depth < INFINITY && memory_exceeded == 0;
+  result.count = retained_nodes - prime_nodes;
+  result.literals = 0;
+  for(cursor = prime_nodes ; cursor < retained_nodes ; cursor++)
+	result.literals += input_cost((*cursor)->cube);
+  (void)write(fd,(char *)&result,sizeof(result));
+  for(cursor = prime_nodes ; cursor < retained_nodes ; cursor++)
+   { (void)write(fd,(char *)(*cursor)->cube,
+		 (unsigned)total_length * sizeof(long int));
+   }
+  _exit(0);
+}
+
+/***********************************************************************/
+
+/* read_solution reads count cubes on fd in a list of nodes */
+
+static struct node *read_solution(fd,count)
+
+int fd,count;
+{
+  struct node *solution,**end;
+
+  solution = NULL;
+  end = &solution;
+  for(; count > 0 ; count--)
+   { if(!read_fully(fd,(char *)spare_node->cube,
+		    (int)(total_length * sizeof(long int))))
+	fatal_system_error("a portfolio worker failed");
+     *end = copy_and_alloc_node(spare_node->cube);
+     end = &(*end)->next_node;
+   }
+  *end = NULL;
+  return(solution);
+}
+
+/***********************************************************************/
+
+portfolio_covering(list)
+
+struct node *list;
+{
+  struct portfolio_result result,best_result;
+
+  struct pollfd *polled;	/* pipe of each worker still running */
+
+  struct node
+	*solution,	/* cubes of the solution received */
+	*best,		/* cubes of the best solution */
+	*temp_node;
+
+  pid_t *worker;		/* pid of each worker */
+
+  int
+	nb_workers,	/* number of workers */
+	running,	/* workers not read yet */
+	best_worker,	/* worker of the best solution */
+	channel[2],	/* pipe from a worker */
+	fd,i,count;
+
+  nb_workers = max_jobs > 1 ? max_jobs : nb_branch_rules;
+  fd = open("/dev/zero",O_RDWR);
+  if(fd < 0) fatal_system_error("unable to open /dev/zero");
+  board = (struct portfolio_board *)mmap((void *)NULL,
+		sizeof(struct portfolio_board),PROT_READ | PROT_WRITE,
+		MAP_SHARED,fd,(off_t)0);
+  close(fd);
+  if(board == (struct portfolio_board *)MAP_FAILED)
+	fatal_system_error("unable to map the portfolio board");
+  board->best_count = INFINITY;
+  board->solved = 0;
+
+  worker = (pid_t *)calloc((unsigned)nb_workers,sizeof(pid_t));
+  polled = (struct pollfd *)calloc((unsigned)nb_workers,sizeof(struct pollfd));
+  if(worker == NULL || polled == NULL)
+	fatal_system_error("unable to alloc the portfolio");
+
+  for(i = 0 ; i < nb_workers ; i++)
+   { fflush(stdout);
+     fflush(stderr);
+     fflush(output_file);
+     if(pipe(channel) != 0) fatal_system_error("unable to open a pipe");
+     worker[i] = fork();
+     if(worker[i] < 0) fatal_system_error("unable to fork a portfolio worker");
+     if(worker[i] == 0)
+      { close(channel[0]);
+	for(count = 0 ; count < i ; count++) close(polled[count].fd);
+	run_worker(list,i,channel[1]);
+      }
+     close(channel[1]);
+     polled[i].fd = channel[0];
+     polled[i].events = POLLIN;
+   }
+
+/* the results are read as the workers finish; a minimum solution stops
+   the others.								*/
+
+  best = NULL;
+  best_worker = -1;
+  for(running = nb_workers ; running > 0 && board->solved == 0 ;)
+   { if(poll(polled,(unsigned long)nb_workers,-1) < 0) continue;
+     for(i = 0 ; i < nb_workers ; i++)
+      { if(polled[i].fd < 0 || polled[i].revents == 0) continue;
+	if(read_fully(polled[i].fd,(char *)&result,sizeof(result)))
+	 { solution = read_solution(polled[i].fd,result.count);
+	   sprintf(error_buffer,"portfolio : worker %d %s %d cubes %d literals%s",
+		   i,branch_rules[worker_rule(i)].name,result.count,
+		   result.literals,result.exact ? " minimum" : "");
+	   if(best_worker < 0 || result.count < best_result.count ||
+	      (result.count == best_result.count &&
+	       result.literals < best_result.literals) ||
+	      (result.exact && !best_result.exact))
+	    { free_list_of_nodes(&best);
+	      best = solution;
+	      best_result = result;
+	      best_worker = i;
+	      board->best_count = result.count;
+	      if(result.exact) board->solved = 1;
+	    }
+	   else free_list_of_nodes(&solution);
+	 }
+	else sprintf(error_buffer,"portfolio : worker %d %s stopped",
+		     i,branch_rules[worker_rule(i)].name);
+	if(VERBOSIS)send_user_message(error_buffer);
+	send_file_dtime(error_buffer);
+	close(polled[i].fd);
+	polled[i].fd = -1;
+	running--;
+      }
+   }
+
+  for(i = 0 ; i < nb_workers ; i++)
+   { if(polled[i].fd < 0) continue;
+     (void)kill(worker[i],SIGKILL);
+     close(polled[i].fd);
+   }
+  for(i = 0 ; i < nb_workers ; i++) (void)waitpid(worker[i],(int *)NULL,0);
+  munmap((char *)board,sizeof(struct portfolio_board));
+  board = NULL;
+  free((char *)worker);
+  free((char *)polled);
+  if(best_worker < 0) fatal_system_error("no portfolio worker succeeded");
+
+/* the solution is placed in the vector as find_best_covering leaves it */
+
+  prime_count = 0;
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+	prime_count++;
+  free_list_of_nodes(&list);
+  prime_nodes = (struct node **)
+	calloc((unsigned)(best_result.count + 1),sizeof(struct node *));
+  if(prime_nodes == NULL) fatal_system_error("unable to allocate prime_nodes");
+  retained_nodes = prime_nodes;
+  for(temp_node = best ; temp_node != NULL ; temp_node = temp_node->next_node)
+	*(retained_nodes++) = temp_node;
+  unretain_nodes = retained_nodes;
+  end_prime = retained_nodes;
+  max_branching_depth = best_result.depth;
+  memory_exceeded |= best_result.exceeded;
+  branch_rule_number = worker_rule(best_worker);
+
+  sprintf(error_buffer,"portfolio : the solution of worker %d contains %d nodes",
+	  best_worker,best_result.count);
+  if(VERBOSIS)send_user_dtime(error_buffer);
+  send_file_dtime(error_buffer);
+}
+
+/***********************************************************************/
+
+portfolio_bound()
+
+{
+  if(portfolio_cut((int)(retained_nodes - prime_nodes))) _exit(0);
+}
+
+/***********************************************************************/
+
+int portfolio_cut(count)
+
+int count;
+{
+  return(in_worker && board != NULL && count > board->best_count);
+}
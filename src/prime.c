@@ -348,7 +348,8 @@ struct branch *branch;
    point_to_merge is already updated to point to the next node	*/
 
   for(; (node_to_merge = *point_to_merge) != NULL ;)
-   { if(merge_with_rest(&(common_binary->is1)) == 0) 
+   { PROGRESS();
+     if(merge_with_rest(&(common_binary->is1)) == 0) 
 			point_to_merge = &(node_to_merge->next_node);
    }
   
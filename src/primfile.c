@@ -0,0 +1,394 @@
+/*********************************************************************
+
+NAME
+	save_prime_implicants, save_prime_cover, load_prime_implicants,
+	function_hash
+
+PURPOSE
+	The generation of the prime implicants often takes much longer
+	than the covering, which is run again on the same function with
+	other switches, -b or -min for instance. The graph of the prime
+	implicants is kept in a file, given with -save-primes, and read
+	back with -load-primes instead of being generated. The cover found
+	is kept with it, for a run on the function changed by -add and -del.
+
+SYNOPSIS
+	save_prime_implicants(function,graph,list)
+	unsigned long function;
+	int graph;
+	struct node *list;
+
+	save_prime_cover()
+
+	struct node *load_prime_implicants(function,list,graph)
+	unsigned long function;
+	struct node *list;
+	int *graph;
+
+	unsigned long function_hash(list)
+	struct node *list;
+
+DESCRIPTION
+    -function_hash returns a hash of the cubes read, in their order, and
+	of -nint, which the prime implicants depend on.
+
+    -save_prime_implicants writes the list of prime implicants linked in
+	a graph, as an engine returns it, in the file -save-primes: a
+	header with the hash of the function read, the size of the cubes,
+	the number of nodes and of links, graph telling whether all the
+	prime implicants are in the graph, PRIME_ALL, and whether every
+	pair of intersecting nodes is linked, PRIME_LINKED, then the cubes,
+	the number of ancestors and of descendants of each node, the rank
+	in the list of each ancestor and descendant, in the order of their
+	lists, and the status of each node, padded to an int. The scans of
+	the covering follow the lists in this order, so the covering of
+	the graph read back is the one of the graph generated.
+
+    -save_prime_cover is called once the graph saved is covered. When the
+	covering reached the minimum, not stopped by the depth limit nor by
+	the memory budget, the rank of each node retained is appended to
+	the file and counted in its header. The cover of -branch portfolio,
+	made of copies of the nodes, is not kept.
+
+    -load_prime_implicants maps the file -load-primes in memory and, when
+	it was saved for the function read, builds the nodes and their
+	links from it and frees the list read. The id of a node is 1 when
+	it is in the cover kept in the file, 0 otherwise, and graph, when
+	not NULL, receives the graph of the header. When the file is of
+	another function, the user is warned and NULL is returned; the
+	prime implicants are then generated.
+
+*********************************************************************/
+
+#define _XOPEN_SOURCE 600
+
+#include "cubes.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define PRIME_MAGIC "MCBPRIME"
+#define PRIME_VERSION 2
+
+struct prime_header
+ { char magic[8];		/* PRIME_MAGIC */
+   int version;			/* PRIME_VERSION */
+   int word_size;		/* bytes in a long int of the cubes */
+   int inputs;			/* number of inputs */
+   int outputs;			/* number of outputs */
+   int nodes;			/* number of prime implicants */
+   int links;			/* number of ancestors and descendants */
+   int graph;			/* PRIME_ALL and PRIME_LINKED */
+   int cover;			/* number of nodes of the cover kept */
+   unsigned long function;	/* hash of the function read */
+ };
+
+/* the status of the nodes, in short int, is padded to an int */
+
+#define STATUS_SIZE(nodes) ((((long)(nodes) * sizeof(short int) + \
+	sizeof(int) - 1) / sizeof(int)) * sizeof(int))
+
+/***********************************************************************/
+
+unsigned long function_hash(list)
+
+struct node *list;
+{
+  unsigned long hash;
+
+  int i;
+
+  hash = 0xcbf29ce484222325UL ^ DISJOINT_REQUIRED;
+  for(; list != NULL ; list = list->next_node)
+   { for(i = 0 ; i < total_length ; i++)
+      { hash = (hash ^ (unsigned long)list->cube[i]) * 0x100000001b3UL;
+	hash ^= hash >> 29;
+      }
+   }
+  return(hash);
+}
+
+/***********************************************************************/
+
+/* count_parents returns the number of elements of a parent list */
+
+static int count_parents(parent)
+
+struct parent *parent;
+{
+  int count;
+
+  for(count = 0 ; parent != NULL ; parent = parent->next_parent) count++;
+  return(count);
+}
+
+/***********************************************************************/
+
+save_prime_implicants(function,graph,list)
+
+unsigned long function;
+int graph;
+struct node *list;
+{
+  struct prime_header header;
+
+  struct node *temp_node;
+
+  struct parent *temp_parent;
+
+  FILE *fp;
+
+  short int pad;
+
+  int rank,failed;
+
+  fp = fopen(save_primes_path,"w");
+  if(fp == NULL)
+   { warning_user_error("unable to write the prime implicants file");
+     return;
+   }
+
+/* the id of each node holds its rank in the list while it is written */
+
+  memset((char *)&header,0,sizeof(header));
+  memcpy(header.magic,PRIME_MAGIC,sizeof(header.magic));
+  header.version = PRIME_VERSION;
+  header.word_size = sizeof(long int);
+  header.inputs = input_number;
+  header.outputs = output_number;
+  header.graph = graph;
+  header.function = function;
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { temp_node->id = header.nodes++;
+     header.links += count_parents(temp_node->ancestors) +
+		     count_parents(temp_node->descendants);
+   }
+
+  failed = fwrite((char *)&header,sizeof(header),1,fp) != 1;
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+	failed |= fwrite((char *)temp_node->cube,sizeof(long int),
+			 (unsigned)total_length,fp) != total_length;
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { rank = count_parents(temp_node->ancestors);
+     failed |= fwrite((char *)&rank,sizeof(int),1,fp) != 1;
+   }
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { rank = count_parents(temp_node->descendants);
+     failed |= fwrite((char *)&rank,sizeof(int),1,fp) != 1;
+   }
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+   { temp_parent = temp_node->ancestors;
+     for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
+      { rank = temp_parent->parent->id;
+	failed |= fwrite((char *)&rank,sizeof(int),1,fp) != 1;
+      }
+     temp_parent = temp_node->descendants;
+     for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
+      { rank = temp_parent->parent->id;
+	failed |= fwrite((char *)&rank,sizeof(int),1,fp) != 1;
+      }
+   }
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+	failed |= fwrite((char *)&temp_node->status,sizeof(short int),1,fp) != 1;
+  pad = 0;
+  for(rank = header.nodes * sizeof(short int) ;
+      rank < STATUS_SIZE(header.nodes) ; rank += sizeof(short int))
+	failed |= fwrite((char *)&pad,sizeof(short int),1,fp) != 1;
+  if(fclose(fp) != 0) failed = 1;
+
+  for(temp_node = list ; temp_node != NULL ; temp_node = temp_node->next_node)
+	temp_node->id = 0;
+  if(failed) warning_user_error("unable to write the prime implicants file");
+  else if(VERBOSIS)
+   { sprintf(error_buffer,"%d prime implicants and %d links saved",
+	     header.nodes,header.links);
+     send_user_message(error_buffer);
+   }
+}
+
+/***********************************************************************/
+
+save_prime_cover()
+
+{
+  struct prime_header header;
+
+  struct node **cursor;
+
+  FILE *fp;
+
+  int rank,failed;
+
+  if(memory_exceeded || max_branching_depth >= INFINITY ||
+     strcmp(branch_rule,"portfolio") == 0) return;
+  fp = fopen(save_primes_path,"r+");
+  if(fp == NULL)
+   { warning_user_error("unable to write the cover of the prime implicants");
+     return;
+   }
+
+/* the id of each node is its rank in the list saved, as find_best_covering
+   set it.								*/
+
+  failed = fread((char *)&header,sizeof(header),1,fp) != 1 ||
+	   header.nodes != prime_count || header.cover != 0 ||
+	   fseek(fp,0L,SEEK_END) != 0;
+  for(cursor = prime_nodes ; failed == 0 && cursor < retained_nodes ; cursor++)
+   { if((*cursor)->status & DONT_CARE) continue;
+     rank = (*cursor)->id;
+     failed |= fwrite((char *)&rank,sizeof(int),1,fp) != 1;
+     header.cover++;
+   }
+  if(failed == 0)
+	failed = fseek(fp,0L,SEEK_SET) != 0 ||
+		 fwrite((char *)&header,sizeof(header),1,fp) != 1;
+  if(fclose(fp) != 0) failed = 1;
+  if(failed)
+	warning_user_error("unable to write the cover of the prime implicants");
+  else if(VERBOSIS)
+   { sprintf(error_buffer,"%d nodes of the cover saved",header.cover);
+     send_user_message(error_buffer);
+   }
+}
+
+/***********************************************************************/
+
+/* build_parents links node to the nodes of ranks given, in their order */
+
+static struct parent *build_parents(vector,ranks,count)
+
+struct node **vector;
+int *ranks,count;
+{
+  struct parent *first,**last;
+
+  first = NULL;
+  last = &first;
+  for(; count > 0 ; count--)
+   { *last = alloc_parent();
+     (*last)->parent = vector[*(ranks++)];
+     last = &(*last)->next_parent;
+   }
+  *last = NULL;
+  return(first);
+}
+
+/***********************************************************************/
+
+struct node *load_prime_implicants(function,list,graph)
+
+unsigned long function;
+struct node *list;
+int *graph;
+{
+  struct prime_header *header;
+
+  struct node
+	**vector,	/* node of each rank */
+	*primes;	/* list of the nodes built */
+
+  struct stat file_status;
+
+  char *map;
+
+  long int *cube;
+
+  int
+	*nb_ancestors,	/* number of ancestors of each node */
+	*nb_descendants,/* number of descendants of each node */
+	*ranks,		/* ranks of the parents */
+	*cover,		/* ranks of the nodes of the cover */
+	fd,i,links;
+
+  short int *status;
+
+  long size;
+
+  fd = open(load_primes_path,O_RDONLY);
+  if(fd < 0 || fstat(fd,&file_status) != 0)
+	fatal_user_error("unable to open the prime implicants file");
+  size = file_status.st_size;
+  map = NULL;
+  if(size >= (long)sizeof(struct prime_header))
+   { map = (char *)mmap((void *)NULL,(size_t)size,PROT_READ,MAP_PRIVATE,fd,
+			(off_t)0);
+     if(map == (char *)MAP_FAILED) map = NULL;
+   }
+  close(fd);
+  if(map == NULL) fatal_user_error("unable to read the prime implicants file");
+
+/* the file must be of the function read, complete, and of this machine */
+
+  header = (struct prime_header *)map;
+  if(memcmp(header->magic,PRIME_MAGIC,sizeof(header->magic)) != 0 ||
+     header->version != PRIME_VERSION ||
+     header->word_size != sizeof(long int) ||
+     header->inputs != input_number || header->outputs != output_number ||
+     header->function != function || header->nodes < 0 ||
+     header->links < 0 || header->cover < 0 ||
+     size != (long)sizeof(struct prime_header) +
+	(long)header->nodes * (total_length * sizeof(long int) +
+	2 * sizeof(int)) + STATUS_SIZE(header->nodes) +
+	((long)header->links + header->cover) * sizeof(int))
+   { munmap(map,(size_t)size);
+     warning_user_error("the prime implicants file is of another function");
+     return(NULL);
+   }
+
+  cube = (long int *)(map + sizeof(struct prime_header));
+  nb_ancestors = (int *)(cube + (long)header->nodes * total_length);
+  nb_descendants = nb_ancestors + header->nodes;
+  ranks = nb_descendants + header->nodes;
+  status = (short int *)(ranks + header->links);
+  cover = (int *)((char *)status + STATUS_SIZE(header->nodes));
+
+  links = 0;
+  for(i = 0 ; i < header->nodes ; i++)
+   { if(nb_ancestors[i] < 0 || nb_descendants[i] < 0) break;
+     links += nb_ancestors[i] + nb_descendants[i];
+   }
+  for(i = 0 ; i < header->links ; i++)
+   { if(ranks[i] < 0 || ranks[i] >= header->nodes) break;
+   }
+  if(links != header->links || i < header->links)
+	fatal_user_error("the prime implicants file is damaged");
+  for(i = 0 ; i < header->cover ; i++)
+   { if(cover[i] < 0 || cover[i] >= header->nodes)
+	fatal_user_error("the prime implicants file is damaged");
+   }
+
+/* the nodes are built, then linked to their parents */
+
+  vector = (struct node **)
+	calloc((unsigned)(header->nodes + 1),sizeof(struct node *));
+  if(vector == NULL) fatal_system_error("unable to alloc the prime vector");
+  primes = NULL;
+  for(i = header->nodes - 1 ; i >= 0 ; i--)
+   { vector[i] = copy_and_alloc_node(cube + (long)i * total_length);
+     vector[i]->status = status[i];
+     vector[i]->id = 0;
+     vector[i]->next_node = primes;
+     primes = vector[i];
+   }
+  for(i = 0 ; i < header->nodes ; i++)
+   { vector[i]->ancestors = build_parents(vector,ranks,nb_ancestors[i]);
+     ranks += nb_ancestors[i];
+     vector[i]->descendants = build_parents(vector,ranks,nb_descendants[i]);
+     ranks += nb_descendants[i];
+   }
+  for(i = 0 ; i < header->cover ; i++) vector[cover[i]]->id = 1;
+  if(graph != NULL) *graph = header->graph;
+
+  if(VERBOSIS)
+   { sprintf(error_buffer,"%d prime implicants and %d links loaded",
+	     header->nodes,header->links);
+     send_user_message(error_buffer);
+   }
+  free((char *)vector);
+  munmap(map,(size_t)size);
+  free_list_of_nodes(&list);
+  return(primes);
+}
@@ -0,0 +1,197 @@
+/*********************************************************************
+
+NAME
+	profile_begin, profile_end, profile_report
+
+PURPOSE
+	The times printed with the messages have a resolution of one second
+	and most phases of a run take less. These functions measure each
+	phase of the program with the monotonic and the process clocks of
+	POSIX, which have a resolution of a nanosecond, and report them.
+
+SYNOPSIS
+	profile_begin(phase)
+	int phase;
+
+	profile_end(phase)
+	int phase;
+
+	profile_report()
+
+DESCRIPTION
+    -profile_begin records the wall clock and cpu time at the start of
+	one of the phases PHASE_READ, PHASE_PRIME, PHASE_EPI, PHASE_BRANCH,
+	PHASE_SPARSE, PHASE_WRITE and PHASE_SPLIT.
+
+    -profile_end adds the wall clock and cpu time elapsed since the
+	matching profile_begin to the totals of the phase and counts one
+	more call of the phase. The bytes reserved by the allocation pools
+	at the end of the phase are kept with its highest value and, in
+	very verbose mode, the statistics of each pool are sent.
+
+    -profile_report prints the totals of each phase called, the peak
+	resident memory and the statistics of the allocation pools, in
+	verbose mode. When a file was given with
+	-stats, the same information, with the size of the function and
+	of the solution, is written to it in JSON.
+
+	When compiled with COUNTERS, the counters of the operations done
+	in the cube functions and in the graph scans are reported with the
+	phases, with the average number of nodes visited per scan pass.
+
+	The phase PHASE_SPLIT covers the minimization of all the output
+	components with -split; the phases done in this process for the
+	components are also counted in their own phase.
+
+*********************************************************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "cubes.h"
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+struct phase_time
+ { double wall;			/* wall clock time in seconds */
+   double cpu;			/* cpu time of the process in seconds */
+   double wall_start;		/* wall clock at the last begin */
+   double cpu_start;		/* cpu time at the last begin */
+   long calls;			/* number of times the phase was done */
+   long reserved;		/* highest bytes reserved in the pools at end */
+ };
+
+int current_phase = -1;	/* phase begun last */
+
+char *phase_name[NB_PHASES] =
+ { "read", "prime", "epi", "branch", "sparse", "write", "split",
+   "verify" };
+
+static struct phase_time phase_time[NB_PHASES];
+
+#ifdef COUNTERS
+long op_counter[NB_COUNTERS];	/* operations counted since the start */
+
+static char *counter_name[NB_COUNTERS] =
+ { "star_product", "star_product_merged", "covers", "absorb",
+   "sharp_splits", "intersect_list_visits", "scan_passes", "scan_visits",
+   "merge_case_0", "merge_case_1", "merge_case_2", "merge_case_3" };
+#endif
+
+/***********************************************************************/
+
+static double clock_seconds(clock)
+
+clockid_t clock;
+{
+  struct timespec now;
+
+  if(clock_gettime(clock,&now) != 0) return(0.0);
+  return(now.tv_sec + now.tv_nsec / 1e9);
+}
+
+/***********************************************************************/
+
+profile_begin(phase)
+
+int phase;
+{
+  current_phase = phase;
+  phase_time[phase].wall_start = clock_seconds(CLOCK_MONOTONIC);
+  phase_time[phase].cpu_start = clock_seconds(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+/***********************************************************************/
+
+profile_end(phase)
+
+int phase;
+{
+  struct phase_time *p;
+
+  long reserved;		/* bytes reserved in the pools */
+
+  p = phase_time + phase;
+  p->wall += clock_seconds(CLOCK_MONOTONIC) - p->wall_start;
+  p->cpu += clock_seconds(CLOCK_PROCESS_CPUTIME_ID) - p->cpu_start;
+  p->calls++;
+  reserved = alloc_bytes_reserved();
+  if(reserved > p->reserved) p->reserved = reserved;
+  if(VERY_VERBOSIS) report_alloc_stats(phase_name[phase]);
+}
+
+/***********************************************************************/
+
+profile_report()
+
+{
+  struct rusage usage;		/* resources used by the process */
+
+  long peak_rss;		/* peak resident memory in kbytes */
+
+  int i,first;
+
+  peak_rss = 0;
+  if(getrusage(RUSAGE_SELF,&usage) == 0) peak_rss = usage.ru_maxrss;
+
+  if(VERBOSIS)
+   { for(i = 0 ; i < NB_PHASES ; i++)
+      { if(phase_time[i].calls == 0) continue;
+	sprintf(error_buffer,"phase %-6s wall %.6fs cpu %.6fs calls %ld",
+		phase_name[i],phase_time[i].wall,phase_time[i].cpu,
+		phase_time[i].calls);
+	send_user_message(error_buffer);
+      }
+     sprintf(error_buffer,"peak resident memory %ld kbytes",peak_rss);
+     send_user_message(error_buffer);
+     report_alloc_stats("exit");
+#ifdef COUNTERS
+     for(i = 0 ; i < NB_COUNTERS ; i++)
+      { sprintf(error_buffer,"counter %-22s %ld",counter_name[i],
+		op_counter[i]);
+	send_user_message(error_buffer);
+      }
+     sprintf(error_buffer,"counter %-22s %.1f","scan_visits_per_pass",
+	op_counter[COUNT_SCAN_PASS] ? (double)op_counter[COUNT_SCAN_VISIT] /
+				      op_counter[COUNT_SCAN_PASS] : 0.0);
+     send_user_message(error_buffer);
+#endif
+   }
+
+  if(stats_file == NULL) return;
+  fprintf(stats_file,"{\n  \"cubes\": %d,\n",stats_cubes);
+  fprintf(stats_file,"  \"inputs\": %d,\n  \"outputs\": %d,\n",
+	  input_number,output_number);
+  fprintf(stats_file,"  \"primes\": %d,\n",prime_count);
+  fprintf(stats_file,"  \"solution\": %d,\n",(int)(retained_nodes - prime_nodes));
+  fprintf(stats_file,"  \"max_branching_depth\": %d,\n",max_branching_depth);
+  fprintf(stats_file,"  \"branch_rule\": \"%s\",\n",
+	  branch_rules[branch_rule_number].name);
+  fprintf(stats_file,"  \"peak_rss_kbytes\": %ld,\n",peak_rss);
+  fprintf(stats_file,"  \"memory_budget_reached\": %s,\n",
+	  memory_exceeded & MEMORY_CUT ? "\"primes\"" :
+	  memory_exceeded ? "\"covering\"" : "false");
+  fprintf(stats_file,"  \"pools\": ");
+  foutput_alloc_stats(stats_file);
+  fprintf(stats_file,",\n  \"phases\": {");
+  first = 1;
+  for(i = 0 ; i < NB_PHASES ; i++)
+   { if(phase_time[i].calls == 0) continue;
+     fprintf(stats_file,"%s\n    \"%s\": { \"wall_ns\": %.0f, \"cpu_ns\": %.0f, ",
+	     first ? "" : ",",phase_name[i],phase_time[i].wall * 1e9,
+	     phase_time[i].cpu * 1e9);
+     fprintf(stats_file,"\"calls\": %ld, \"pool_bytes_reserved\": %ld }",
+	     phase_time[i].calls,phase_time[i].reserved);
+     first = 0;
+   }
+#ifdef COUNTERS
+  fprintf(stats_file,"\n  },\n  \"counters\": {");
+  for(i = 0 ; i < NB_COUNTERS ; i++)
+   { fprintf(stats_file,"%s\n    \"%s\": %ld",i ? "," : "",counter_name[i],
+	     op_counter[i]);
+   }
+#endif
+  fprintf(stats_file,"\n  }\n}\n");
+  fclose(stats_file);
+  stats_file = NULL;
+}
@@ -0,0 +1,215 @@
+/*********************************************************************
+
+NAME
+	start_progress, report_progress, stop_progress
+
+PURPOSE
+	A long run gives no news between the messages of the verbose mode,
+	which are too many to follow. These functions give, once per
+	second, one line telling where the run is, and keep it in a status
+	file that another program can read.
+
+SYNOPSIS
+	start_progress()
+
+	report_progress()
+
+	stop_progress()
+
+	PROGRESS()
+
+DESCRIPTION
+    -start_progress arms an interval timer of one second when -progress
+	or -status was given. The signal handler only sets progress_due.
+
+    -PROGRESS is placed in the main loops of the prime implicant engines
+	and of the covering; it calls report_progress when progress_due
+	is set, so that the state is read between two operations.
+
+    -report_progress prints on stderr, with -progress, the time elapsed,
+	the current phase, the number of nodes allocated, the number of
+	prime implicants being covered, the nodes decided and undecided,
+	the current and maximum branching depth and the resident memory.
+	With -status, the same information is written in JSON to the
+	file given, through a temporary file renamed on it, so that the
+	file read is always complete.
+
+    -stop_progress disarms the timer and writes the status a last time,
+	with the state done.
+
+*********************************************************************/
+
+#define _XOPEN_SOURCE 600
+
+#include "cubes.h"
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+volatile sig_atomic_t progress_due = 0;	/* set each second by the timer */
+
+static double progress_start;		/* wall clock at the start */
+
+static int progress_on = 0;		/* the timer is armed */
+
+/***********************************************************************/
+
+static void progress_alarm(sig)
+
+int sig;
+{
+  progress_due = 1;
+}
+
+/***********************************************************************/
+
+static double wall_seconds()
+
+{
+  struct timeval now;
+
+  gettimeofday(&now,(struct timezone *)NULL);
+  return(now.tv_sec + now.tv_usec / 1e6);
+}
+
+/***********************************************************************/
+
+/* resident_kbytes returns the resident memory, or its peak when the
+   current value is not available.					*/
+
+static long resident_kbytes()
+
+{
+  struct rusage usage;
+
+  FILE *fp;
+
+  long size,resident;
+
+  fp = fopen("/proc/self/statm","r");
+  if(fp != NULL)
+   { if(fscanf(fp,"%ld %ld",&size,&resident) == 2)
+      { fclose(fp);
+	return(resident * (sysconf(_SC_PAGESIZE) / 1024));
+      }
+     fclose(fp);
+   }
+  if(getrusage(RUSAGE_SELF,&usage) == 0) return(usage.ru_maxrss);
+  return(0);
+}
+
+/***********************************************************************/
+
+/* write_status prints the state of the run on the file, in JSON when
+   json is set.								*/
+
+static write_status(file,state,json)
+
+FILE *file;
+char *state;
+int json;
+{
+  int decided,undecided;
+
+  decided = 0;
+  undecided = 0;
+  if(prime_nodes != NULL && current_phase >= PHASE_EPI &&
+     current_phase <= PHASE_SPARSE)
+   { decided = (retained_nodes - prime_nodes) + (end_prime - unretain_nodes);
+     undecided = unretain_nodes - retained_nodes;
+   }
+
+  if(json)
+   { fprintf(file,"{ \"state\": \"%s\", \"elapsed_s\": %.1f, ",state,
+	     wall_seconds() - progress_start);
+     fprintf(file,"\"phase\": \"%s\", \"nodes\": %d, \"primes\": %d, ",
+	     current_phase < 0 ? "none" : phase_name[current_phase],
+	     nb_alloc_nodes,prime_count);
+     fprintf(file,"\"decided\": %d, \"undecided\": %d, ",decided,undecided);
+     fprintf(file,"\"branching_depth\": %d, \"max_branching_depth\": %d, ",
+	     branching_depth,max_branching_depth);
+     fprintf(file,"\"rss_kbytes\": %ld }\n",resident_kbytes());
+   }
+  else
+   { fprintf(file,"McBOOLE : %.0fs %-6s nodes %d primes %d ",
+	     wall_seconds() - progress_start,
+	     current_phase < 0 ? "none" : phase_name[current_phase],
+	     nb_alloc_nodes,prime_count);
+     fprintf(file,"decided %d undecided %d depth %d max %d rss %ld kbytes\n",
+	     decided,undecided,branching_depth,max_branching_depth,
+	     resident_kbytes());
+   }
+}
+
+/***********************************************************************/
+
+static update_status_file(state)
+
+char *state;
+{
+  char temp_path[256];
+
+  FILE *fp;
+
+  if(status_path[0] == '\0') return;
+  sprintf(temp_path,"%.240s.tmp",status_path);
+  fp = fopen(temp_path,"w");
+  if(fp == NULL) return;
+  write_status(fp,state,1);
+  fclose(fp);
+  (void)rename(temp_path,status_path);
+}
+
+/***********************************************************************/
+
+start_progress()
+
+{
+  struct sigaction action;
+
+  struct itimerval timer;
+
+  progress_start = wall_seconds();
+  if(PROGRESS_LINE == 0 && status_path[0] == '\0') return;
+
+/* the system calls interrupted by the signal are restarted, the pipes of
+   the output components are read in full.				*/
+
+  memset((char *)&action,0,sizeof(action));
+  action.sa_handler = progress_alarm;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if(sigaction(SIGALRM,&action,(struct sigaction *)NULL) != 0) return;
+  timer.it_interval.tv_sec = 1;
+  timer.it_interval.tv_usec = 0;
+  timer.it_value = timer.it_interval;
+  if(setitimer(ITIMER_REAL,&timer,(struct itimerval *)NULL) != 0) return;
+  progress_on = 1;
+  update_status_file("running");
+}
+
+/***********************************************************************/
+
+report_progress()
+
+{
+  progress_due = 0;
+  if(PROGRESS_LINE) write_status(stderr,"running",0);
+  update_status_file("running");
+}
+
+/***********************************************************************/
+
+stop_progress()
+
+{
+  struct itimerval timer;
+
+  if(progress_on == 0) return;
+  memset((char *)&timer,0,sizeof(timer));
+  (void)setitimer(ITIMER_REAL,&timer,(struct itimerval *)NULL);
+  progress_on = 0;
+  progress_due = 0;
+  update_status_file("done");
+}
@@ -1,5 +1,116 @@
-
 #include "cubes.h"
+#include <stdlib.h>
+
+/**********************************************************************
+
+NAME
+	init_scan_stack, SCAN_ENTER, SCAN_PUSH, SCAN_PUSH_BOTH, SCAN_POP
+
+PURPOSE
+	The scans of the graph follow the ancestors and descendants of the
+	nodes depth first. Written as recursive functions, a long chain
+	of nodes in the graph gave as deep a chain of calls and could
+	overflow the stack of the process. The nodes still to scan are
+	kept instead in a work stack, allocated once for each covering,
+	and each scan is a loop on it.
+
+SYNOPSIS
+	init_scan_stack()
+
+	SCAN_ENTER(frame,node,kind)
+	SCAN_PUSH(frame,node,kind)
+	SCAN_PUSH_BOTH(frame,node)
+	struct scan_frame frame;
+	struct node *node;
+	int kind;
+
+	SCAN_POP(base,frame)
+	int base;
+	struct scan_frame frame;
+
+DESCRIPTION
+	A frame is a node with the next element of its ancestors or
+	descendants list to inspect, the kind of the frame telling which
+	list. The frame being scanned is kept by the scan in a local
+	variable, and only the frames waiting are in the work stack.
+
+    -init_scan_stack is called by find_best_covering once prime_count is
+	known. A node takes at most two frames of a scan, one for its
+	descendants and one for its ancestors, so the stack is sized for
+	two frames per prime implicant and is never checked when a frame
+	is pushed. As pass_mark, the stack is kept from a covering to the
+	next and only its new size is charged.
+
+    -SCAN_ENTER makes frame the first one of a scan, for the list of kind
+	of the node given.
+
+    -SCAN_PUSH places frame on top of the work stack, unless its list is
+	done, and makes it the frame of the node given, which is scanned
+	before the frames waiting. The frames waiting have thus always an
+	element left.
+
+    -SCAN_PUSH_BOTH pushes frame and then a frame for the descendants of
+	the node given, and makes frame the one of its ancestors; the
+	ancestors are scanned and then the descendants, as the recursive
+	functions called one and then the other.
+
+    -SCAN_POP is used by the scan when the list of frame is done: frame
+	takes the one on top of the work stack, down to base, the top when
+	the scan started, and 1 is given; 0 when the scan is finished. The
+	scan takes the next element of frame itself, places its node in
+	current_node, and inspects it with the kind of the frame.
+
+	These are macros since they are done for each parent inspected,
+	the most frequent work of the branching. The work stack is shared
+	by all the scans. A scan stopped early, when unretain_inferior_node
+	is called from scan_inferior_ancestors for instance, first sets the
+	top back to its base, so that the scans it starts work from there.
+	The order in which the nodes are visited and the cubes sharped is
+	the one of the recursive functions, so that the same decisions are
+	taken.
+
+*************************************************************************/
+
+#define SCAN_ANCESTORS 0	/* scan the ancestors of the node */
+#define SCAN_DESCENDANTS 1	/* scan its descendants */
+
+struct scan_frame
+ { struct node *node;		/* node whose parents are scanned */
+   struct parent *next;		/* next element of the list to inspect */
+   int kind;			/* list being scanned */
+ };
+
+#define SCAN_ENTER(frame,n,k) ((frame).node = (n), (frame).kind = (k), \
+	(frame).next = (k) == SCAN_DESCENDANTS ? (n)->descendants : (n)->ancestors)
+
+#define SCAN_PUSH(frame,n,k) ((frame).next != NULL && \
+	(scan_stack[scan_top++] = (frame), 1), SCAN_ENTER(frame,n,k))
+
+#define SCAN_PUSH_BOTH(frame,n) (SCAN_PUSH(frame,n,SCAN_DESCENDANTS), \
+	SCAN_PUSH(frame,n,SCAN_ANCESTORS))
+
+#define SCAN_POP(base,frame) (scan_top > (base) && \
+	((frame) = scan_stack[--scan_top], 1))
+
+static struct scan_frame *scan_stack = NULL;	/* the work stack */
+
+static int scan_top = 0;	/* number of frames in the work stack */
+
+static long stack_charge = 0;	/* memory charged for the work stack */
+
+/***********************************************************************/
+
+init_scan_stack()
+
+{
+  scan_stack = (struct scan_frame *)realloc((char *)scan_stack,
+		(unsigned)(2 * prime_count + 2) * sizeof(struct scan_frame));
+  if(scan_stack == NULL) fatal_system_error("unable to alloc scan stack");
+  scan_top = 0;
+  release_memory(stack_charge);
+  stack_charge = (long)(2 * prime_count + 2) * sizeof(struct scan_frame);
+  charge_memory(stack_charge);
+}
 
 /**********************************************************************
 
@@ -8,7 +119,7 @@ NAME
 	scan_affected_unretain_ancestors, scan_affected_unretain_descendants
 
 PURPOSE
-	This recursive function scans all the path in the graph that may
+	These functions scan all the paths in the graph that may
 	contain some nodes that may be affected by the decision taken on
 	a node. If a node is retained, all the undecided nodes that intersect
 	with this node might get completely covered or simply inferior; their
@@ -60,82 +171,81 @@ AUTHOR
 
 *************************************************************************/
 
-scan_affected_retained_descendants()
+/* scan_affected_retained runs the scan of a node retained from the node
+   given, on the list of kind.						*/
+
+static scan_affected_retained(node,kind)
 
+struct node *node;
+int kind;
 {
-  struct parent *temp_parent;	/* parent to inspect */
+  struct scan_frame frame;	/* frame of the parent inspected */
 
-  temp_parent = current_node->descendants;
+  int base;			/* top of the work stack at the start */
 
-  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
-   { current_node = temp_parent->parent;
+  base = scan_top;
+  SCAN_ENTER(frame,node,kind);
+  while(frame.next != NULL || SCAN_POP(base,frame))
+   { current_node = frame.next->parent;
+     frame.next = frame.next->next_parent;
+     COUNT(COUNT_SCAN_VISIT);
+     if(frame.kind == SCAN_DESCENDANTS)
+      {
 
 /* we must check that we do not come back to either the calling node 
    or a node already scanned to avoid passing many times on some node on the 
    graph. 							*/
 
-     if((current_node->count | ONE) == odd_pass_counter)continue;
+	if((PASS_MARK(current_node) | ONE) == odd_pass_counter)continue;
 
 /* if the node is covered there is nothing to do on this side */
 
-     if(current_node->status & COVERED)
-      { current_node->count = pass_counter;
-	continue;
-      }
+	if(current_node->status & COVERED)
+	 { PASS_MARK(current_node) = pass_counter;
+	   continue;
+	 }
 
 /* if the uncovered part of the node intersects with the node retained
    we will sharp it.						*/
 
-     if(intersect_list(scanned_node->cube,current_node->uncovered))
-      { current_node->count = odd_pass_counter;
-	if(disjoint_sharp(&(current_node->uncovered),scanned_node->cube))
-	 { current_node->status |= COVERED;
-	 }
-	if(current_node->status & DECIDED)scan_affected_retained_descendants();
-	else
+	if(intersect_list(scanned_node->cube,current_node->uncovered))
+	 { PASS_MARK(current_node) = odd_pass_counter;
+	   if(disjoint_sharp(&(current_node->uncovered),scanned_node->cube))
+	    { current_node->status |= COVERED;
+	    }
+	   touch_node(current_node);
 
 /* the node is undecided so if it is not already in the affected stack, we
    will put it in it.						*/
 
-	 { if((current_node->status & AFFECTED) == 0) push(current_node);
-	   current_node->status |= AFFECTED_RETAINED;
-	   scan_affected_retained_descendants();
+	   if((current_node->status & DECIDED) == 0)
+	    { if((current_node->status & AFFECTED) == 0) push(current_node);
+	      current_node->status |= AFFECTED_RETAINED;
+	    }
+	   SCAN_PUSH(frame,current_node,SCAN_DESCENDANTS);
 	 }
+	else PASS_MARK(current_node) = pass_counter;
+	continue;
       }
-     else current_node->count = pass_counter;
-   }
-}
-
-/****************************************************************************/
-
-scan_affected_retained_ancestors()
-
-{
-  struct parent *temp_parent;	/* parent to inspect */
-
-  temp_parent = current_node->ancestors;
-
-  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
-   { current_node = temp_parent->parent;
 
 /* we must check that we do not come back to either the calling node 
    or a node already scanned to avoid passing many times on some node on the 
    graph. 							*/
 
-     if(current_node->count == pass_counter)continue;
+     if(PASS_MARK(current_node) == pass_counter)continue;
 
 /* If the node was already scanned for descendants, we will also at this point
    scan its ancestors.						*/
 
-     if(current_node->count == odd_pass_counter)
-      { current_node->count = pass_counter;
-	scan_affected_retained_ancestors();
+     if(PASS_MARK(current_node) == odd_pass_counter)
+      { PASS_MARK(current_node) = pass_counter;
+	SCAN_PUSH(frame,current_node,SCAN_ANCESTORS);
         continue;
       }
 
 /* if the node is covered there is nothing to do on this side */
 
-     current_node->count = pass_counter;
+     PASS_MARK(current_node) = pass_counter;
 
      if(current_node->status & COVERED) continue;
 
@@ -146,100 +256,108 @@ scan_affected_retained_ancestors()
       { if(disjoint_sharp(&(current_node->uncovered),scanned_node->cube))
 	 { current_node->status |= COVERED;
 	 }
-	if(current_node->status & DECIDED)
-	 { scan_affected_retained_ancestors();
-	   current_node = temp_parent->parent;
-	   scan_affected_retained_descendants();
- 	 }
-	else
+	touch_node(current_node);
 
 /* the node is undecided so if it is not already in the affected stack, we
    will put it in it.						*/
 
+	if((current_node->status & DECIDED) == 0)
 	 { if((current_node->status & AFFECTED) == 0) push(current_node);
 	   current_node->status |= AFFECTED_RETAINED;
-	   scan_affected_retained_ancestors();
-	   current_node = temp_parent->parent;
-	   scan_affected_retained_descendants();
 	 }
+	SCAN_PUSH_BOTH(frame,current_node);
       }
    }
 }
 
+/****************************************************************************/
+
+scan_affected_retained_descendants()
+
+{
+  scan_affected_retained(current_node,SCAN_DESCENDANTS);
+}
+
+/****************************************************************************/
+
+scan_affected_retained_ancestors()
+
+{
+  scan_affected_retained(current_node,SCAN_ANCESTORS);
+}
+
 /***************************************************************************/
 
-scan_affected_unretain_descendants()
+/* scan_affected_unretain runs the scan of a node unretained from the node
+   given, on the list of kind.						*/
+
+static scan_affected_unretain(node,kind)
 
+struct node *node;
+int kind;
 {
-  struct parent *temp_parent;	/* parent to inspect */
+  struct scan_frame frame;	/* frame of the parent inspected */
 
-  temp_parent = current_node->descendants;
+  int base;			/* top of the work stack at the start */
 
-  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
-   { current_node = temp_parent->parent;
+  base = scan_top;
+  SCAN_ENTER(frame,node,kind);
+  while(frame.next != NULL || SCAN_POP(base,frame))
+   { current_node = frame.next->parent;
+     frame.next = frame.next->next_parent;
+     COUNT(COUNT_SCAN_VISIT);
+     if(frame.kind == SCAN_DESCENDANTS)
+      {
 
 /* we must check that we do not come back to either the calling node 
    or a node already scanned to avoid passing many times on some node on the 
    graph. 							*/
 
-     if((current_node->count | ONE) == odd_pass_counter)continue;
+	if((PASS_MARK(current_node) | ONE) == odd_pass_counter)continue;
 
 /* if the node is covered there is nothing to do on this side */
 
-     if(current_node->status & COVERED)
-      { current_node->count = pass_counter;
-	continue;
-      }
+	if(current_node->status & COVERED)
+	 { PASS_MARK(current_node) = pass_counter;
+	   continue;
+	 }
 
 /* if the uncovered part of the node intersects with the node unretained
    this part may become essential if this node is the only one not
    unretained to cover it.				*/
 
-     if(intersect_list(scanned_node->cube,current_node->uncovered))
-      { current_node->count = odd_pass_counter;
-	if(current_node->status & DECIDED)scan_affected_unretain_descendants();
-	else
+	if(intersect_list(scanned_node->cube,current_node->uncovered))
+	 { PASS_MARK(current_node) = odd_pass_counter;
 
 /* the node is undecided so if it is not already in the affected stack, we
    will put it in it.						*/
 
-	 { if((current_node->status & AFFECTED) == 0) push(current_node);
-	   current_node->status |= AFFECTED_UNRETAIN;
-	   scan_affected_unretain_descendants();
+	   if((current_node->status & DECIDED) == 0)
+	    { if((current_node->status & AFFECTED) == 0) push(current_node);
+	      current_node->status |= AFFECTED_UNRETAIN;
+	    }
+	   SCAN_PUSH(frame,current_node,SCAN_DESCENDANTS);
 	 }
+	else PASS_MARK(current_node) = pass_counter;
+	continue;
       }
-     else current_node->count = pass_counter;
-   }
-}
-
-/***************************************************************************/
-
-scan_affected_unretain_ancestors()
-
-{
-  struct parent *temp_parent;	/* parent to inspect */
-
-  temp_parent = current_node->ancestors;
-
-  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
-   { current_node = temp_parent->parent;
 
 /* we must check that we do not come back to either the calling node 
    or a node already scanned to avoid passing many times on some node on the 
    graph. 							*/
 
-     if(current_node->count == pass_counter)continue;
+     if(PASS_MARK(current_node) == pass_counter)continue;
 
 /* if the node was already scanned for descendants we will now at this
    point scan it for ancestors.					*/
 
-     if(current_node->count == odd_pass_counter)
-      { current_node->count = pass_counter;
-        scan_affected_unretain_ancestors();
+     if(PASS_MARK(current_node) == odd_pass_counter)
+      { PASS_MARK(current_node) = pass_counter;
+	SCAN_PUSH(frame,current_node,SCAN_ANCESTORS);
 	continue;
       }
 
-     current_node->count = pass_counter;
+     PASS_MARK(current_node) = pass_counter;
 
 /* if the node is covered there is nothing to do on this side */
 
@@ -250,26 +368,36 @@ scan_affected_unretain_ancestors()
    unretained to cover it.				*/
 
      if(intersect_list(scanned_node->cube,current_node->uncovered))
-      { if(current_node->status & DECIDED)
-	 { scan_affected_unretain_ancestors();
-	   current_node = temp_parent->parent;
-	   scan_affected_unretain_descendants();
-	 }
-	else
+      {
 
 /* the node is undecided so if it is not already in the affected stack, we
    will put it in it.						*/
 
+	if((current_node->status & DECIDED) == 0)
 	 { if((current_node->status & AFFECTED) == 0) push(current_node);
 	   current_node->status |= AFFECTED_UNRETAIN;
-	   scan_affected_unretain_ancestors();
-	   current_node = temp_parent->parent;
-	   scan_affected_unretain_descendants();
 	 }
+	SCAN_PUSH_BOTH(frame,current_node);
       }
    }
 }
 
+/***************************************************************************/
+
+scan_affected_unretain_descendants()
+
+{
+  scan_affected_unretain(current_node,SCAN_DESCENDANTS);
+}
+
+/***************************************************************************/
+
+scan_affected_unretain_ancestors()
+
+{
+  scan_affected_unretain(current_node,SCAN_ANCESTORS);
+}
+
 /*****************************************************************************
 
 NAME
@@ -309,90 +437,78 @@ AUTHOR
 
 *************************************************************************/
 
-int scan_inferior_descendants()
+/* scan_inferior runs the inferior scan from the node given, on the list
+   of kind; the work stack is left as it was found when 1 is returned.	*/
 
+static int scan_inferior(node,kind)
+
+struct node *node;
+int kind;
 {
-  struct parent *temp_parent;	/* parent to inspect */
+  struct scan_frame frame;	/* frame of the parent inspected */
 
-  temp_parent = current_node->descendants;
+  int base;			/* top of the work stack at the start */
 
-  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
-   { current_node = temp_parent->parent;
+  base = scan_top;
+  SCAN_ENTER(frame,node,kind);
+  while(frame.next != NULL || SCAN_POP(base,frame))
+   { current_node = frame.next->parent;
+     frame.next = frame.next->next_parent;
+     COUNT(COUNT_SCAN_VISIT);
+     if(frame.kind == SCAN_DESCENDANTS)
+      {
 
 /* we must check that we do not come back to either the calling node 
    or the scanned node to avoid passing many times on some node on the 
    graph. 							*/
 
-     if((current_node->count | ONE) == odd_pass_counter)continue;
+	if((PASS_MARK(current_node) | ONE) == odd_pass_counter)continue;
 
 /* If the node is covered by retained cubes, we can ignore it since it was
    sharped from the scanned cube in the scan covering pass	*/
 
-     if(current_node->status & COVERED) 
-      { current_node->count = pass_counter;
-        continue;
-      }
-
-     if(intersect_list(current_node->cube,scanned_node->uncovered))
-      { current_node->count = odd_pass_counter;
-        if(current_node->status & DECIDED)
-
-/* the node is unretained but covers the uncovered part of the scanned_node
-   so maybe one of its parents is undecided and also covers it and we must
-   scan them.								*/
-
-	 { if(scan_inferior_descendants()) return(1);
+	if(current_node->status & COVERED) 
+	 { PASS_MARK(current_node) = pass_counter;
+	   continue;
 	 }
 
+	if(intersect_list(current_node->cube,scanned_node->uncovered))
+	 { PASS_MARK(current_node) = odd_pass_counter;
+
 /* if the node is undecided and covers the scanned cube and has a lower cost
-   then the scanned cube is unretained inferior.			*/
+   then the scanned cube is unretained inferior. Otherwise, maybe one of
+   its parents is undecided and also covers it and we must scan them.	*/
 
-	else if(covers_list(current_node->cube,scanned_node->uncovered))
-	 { if(current_node->cost <= scanned_node->cost || DONT_MIN_LITERAL)
-	    {
+	   if((current_node->status & DECIDED) == 0 &&
+	      covers_list(current_node->cube,scanned_node->uncovered) &&
+	      (current_node->cost <= scanned_node->cost || DONT_MIN_LITERAL))
+	    { scan_top = base;
 #ifdef CHECK
 	      unretain_inferior_check_node();
 #else
 	      unretain_inferior_node();
 #endif
-              return(1);
+	      return(1);
 	    }
-	   else if(scan_inferior_descendants()) return(1);
-	 }
-	else
-	 { if(scan_inferior_descendants()) return(1);
+	   SCAN_PUSH(frame,current_node,SCAN_DESCENDANTS);
 	 }
+	else PASS_MARK(current_node) = pass_counter;
+	continue;
       }
-     else current_node->count = pass_counter;
-   }
-  return(0);
-}
-
-/**************************************************************************/
-
-int scan_inferior_ancestors()
-
-{
-  struct parent *temp_parent;	/* parent to inspect */
-
-  temp_parent = current_node->ancestors;
-
-  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
-   { current_node = temp_parent->parent;
 
 /* we must check that we do not come back to either the calling node 
    or the scanned node to avoid passing many times on some node on the 
    graph. 							*/
 
-     if(current_node->count == pass_counter)continue;
+     if(PASS_MARK(current_node) == pass_counter)continue;
 
-     if(current_node->count == odd_pass_counter)
-      { current_node->count = pass_counter;
-	if(scan_inferior_ancestors()) return(1);
+     if(PASS_MARK(current_node) == odd_pass_counter)
+      { PASS_MARK(current_node) = pass_counter;
+	SCAN_PUSH(frame,current_node,SCAN_ANCESTORS);
 	continue;
       }
 
-     current_node->count = pass_counter;
+     PASS_MARK(current_node) = pass_counter;
 
 /* If the node is covered by retained cubes, we can ignore it since it was
    sharped from the scanned cube in the scan covering pass	*/
@@ -400,46 +516,45 @@ int scan_inferior_ancestors()
      if(current_node->status & COVERED) continue;
 
      if(intersect_list(current_node->cube,scanned_node->uncovered))
-      { if(current_node->status & DECIDED)
-
-/* the node is unretained but covers the uncovered part of the scanned_node
-   so maybe one of its parents is undecided and also covers it and we must
-   scan them.								*/
-
-	 { if(scan_inferior_ancestors()) return(1);
-	   current_node = temp_parent->parent;
-	   if(scan_inferior_descendants()) return(1);
-	 }
+      {
 
 /* if the node is undecided and covers the scanned cube and has a lower cost
-   then the scanned cube is unretained inferior.			*/
+   then the scanned cube is unretained inferior. Otherwise, maybe one of
+   its parents is undecided and also covers it and we must scan them.	*/
 
-	else if(covers_list(current_node->cube,scanned_node->uncovered))
-	 { if(current_node->cost <= scanned_node->cost || DONT_MIN_LITERAL)
-	    {
+	if((current_node->status & DECIDED) == 0 &&
+	   covers_list(current_node->cube,scanned_node->uncovered) &&
+	   (current_node->cost <= scanned_node->cost || DONT_MIN_LITERAL))
+	 { scan_top = base;
 #ifdef CHECK
-	      unretain_inferior_check_node();
+	   unretain_inferior_check_node();
 #else
-	      unretain_inferior_node();
+	   unretain_inferior_node();
 #endif
-	      return(1);
-	    }
-	   else
-	    { if(scan_inferior_ancestors()) return(1);
-	      current_node = temp_parent->parent;
-	      if(scan_inferior_descendants()) return(1);
-	    }
-	 }
-	else
-	 { if(scan_inferior_ancestors()) return(1);
-	   current_node = temp_parent->parent;
-	   if(scan_inferior_descendants()) return(1);
+	   return(1);
 	 }
+	SCAN_PUSH_BOTH(frame,current_node);
       }
    }
   return(0);
 }
 
+/**************************************************************************/
+
+int scan_inferior_descendants()
+
+{
+  return(scan_inferior(current_node,SCAN_DESCENDANTS));
+}
+
+/**************************************************************************/
+
+int scan_inferior_ancestors()
+
+{
+  return(scan_inferior(current_node,SCAN_ANCESTORS));
+}
+
 /***********************************************************************
 
 NAME
@@ -479,79 +594,80 @@ AUTHOR
 
 *************************************************************************/
 
-int scan_essential_descendants()
+/* scan_essential runs the essential scan from the node given, on the list
+   of kind; the work stack is left as it was found when 1 is returned.	*/
 
+static int scan_essential(node,kind)
+
+struct node *node;
+int kind;
 {
-  struct parent *temp_parent;	/* parent to inspect */
+  struct scan_frame frame;	/* frame of the parent inspected */
 
-  temp_parent = current_node->descendants;
+  int base;			/* top of the work stack at the start */
 
-  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
-   { current_node = temp_parent->parent;
+  base = scan_top;
+  SCAN_ENTER(frame,node,kind);
+  while(frame.next != NULL || SCAN_POP(base,frame))
+   { current_node = frame.next->parent;
+     frame.next = frame.next->next_parent;
+     COUNT(COUNT_SCAN_VISIT);
+     if(frame.kind == SCAN_DESCENDANTS)
+      {
 
 /* we must check that we do not come back to either the calling node 
    or the scanned node to avoid passing many times on some node on the 
    graph. 							*/
 
-     if((current_node->count | ONE) == odd_pass_counter)continue;
+	if((PASS_MARK(current_node) | ONE) == odd_pass_counter)continue;
 
 /* If the node is covered by retained cubes, we can ignore it since it was
    sharped from the scanned cube in the scan covering pass	*/
 
-     if(current_node->status & COVERED) 
-      { current_node->count = pass_counter;
-	continue;
-      }
+	if(current_node->status & COVERED) 
+	 { PASS_MARK(current_node) = pass_counter;
+	   continue;
+	 }
 
-     if(intersect_list(current_node->cube,scanned_cube))
-      { if(current_node->status & DECIDED)
+	if(intersect_list(current_node->cube,scanned_cube))
+	 { if(current_node->status & DECIDED)
 
 /* the node is unretained but covers a part of the scanned_node
    so maybe one of its parents is undecided and also covers it and we must
    scan them.								*/
 
-	 { current_node->count = odd_pass_counter;
-	   if(scan_essential_descendants())return(1);
-	 }
+	    { PASS_MARK(current_node) = odd_pass_counter;
+	      SCAN_PUSH(frame,current_node,SCAN_DESCENDANTS);
+	    }
 
 /* if the node is undecided and covers a part of the scanned cube we sharp it
    and see if any uncovered part remains.				*/
 
-	else
-	 { current_node->count = pass_counter;
- 	   if(disjoint_sharp(&scanned_cube,current_node->cube)) return(1);
+	   else
+	    { PASS_MARK(current_node) = pass_counter;
+	      if(disjoint_sharp(&scanned_cube,current_node->cube))
+	       { scan_top = base;
+		 return(1);
+	       }
+	    }
 	 }
+	else PASS_MARK(current_node) = pass_counter;
+	continue;
       }
-     else current_node->count = pass_counter;
-   }
-  return(0);
-}
-
-/**************************************************************************/
-
-int scan_essential_ancestors()
-
-{
-  struct parent *temp_parent;	/* parent to inspect */
-
-  temp_parent = current_node->ancestors;
-
-  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
-   { current_node = temp_parent->parent;
 
 /* we must check that we do not come back to either the calling node 
    or the scanned node to avoid passing many times on some node on the 
    graph. 							*/
 
-     if(current_node->count == pass_counter)continue;
+     if(PASS_MARK(current_node) == pass_counter)continue;
 
-     if(current_node->count == odd_pass_counter)
-      { current_node->count = pass_counter;
-	if(scan_essential_ancestors()) return(1);
+     if(PASS_MARK(current_node) == odd_pass_counter)
+      { PASS_MARK(current_node) = pass_counter;
+	SCAN_PUSH(frame,current_node,SCAN_ANCESTORS);
 	continue;
       }
 
-     current_node->count = pass_counter;
+     PASS_MARK(current_node) = pass_counter;
 
 /* If the node is covered by retained cubes, we can ignore it since it was
    sharped from the scanned cube in the scan covering pass	*/
@@ -565,22 +681,37 @@ int scan_essential_ancestors()
    so maybe one of its parents is undecided and also covers it and we must
    scan them.								*/
 
-	 { if(scan_essential_ancestors())return(1);
-	   current_node = temp_parent->parent;
-	   if(scan_essential_descendants()) return(1);
+	 { SCAN_PUSH_BOTH(frame,current_node);
 	 }
 
 /* if the node is undecided and covers a part of the scanned cube we sharp it
    and see if any uncovered part remains.				*/
 
-	else
-	 { if(disjoint_sharp(&scanned_cube,current_node->cube)) return(1);
+	else if(disjoint_sharp(&scanned_cube,current_node->cube))
+	 { scan_top = base;
+	   return(1);
 	 }
       }
    }
   return(0);
 }
 
+/**************************************************************************/
+
+int scan_essential_descendants()
+
+{
+  return(scan_essential(current_node,SCAN_DESCENDANTS));
+}
+
+/**************************************************************************/
+
+int scan_essential_ancestors()
+
+{
+  return(scan_essential(current_node,SCAN_ANCESTORS));
+}
+
 /*************************************************************************
 
 NAME
@@ -598,7 +729,8 @@ SYNOPSIS
 
 DESCRIPTION
 	All the nodes which can affect the current node have their pass count
-	set to the pass counter and they are recursively scanned. Also, each
+	set to the pass counter and they are scanned in turn, from the
+	work stack. Also, each
 	node put this way in the partition is counted in scan_count. 
 
 COORDINATES
@@ -613,60 +745,33 @@ AUTHOR
 scan_partition()
 
 {
-  struct parent *temp_parent;	/* parent to inspect */
-
-  struct node *save_current_node;	/* current node saved during scanning */
-
-/* we will now scan its ancestors to find uncovered nodes to scan */
-
-  save_current_node = current_node;
-  temp_parent = current_node->ancestors;
+  struct scan_frame frame;	/* frame of the parent inspected */
 
-  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
-   { current_node = temp_parent->parent;
+  int base;			/* top of the work stack at the start */
 
-     if(current_node->count == pass_counter)continue;
+  base = scan_top;
+  SCAN_ENTER(frame,current_node,SCAN_DESCENDANTS);
+  SCAN_PUSH(frame,current_node,SCAN_ANCESTORS);
+  while(frame.next != NULL || SCAN_POP(base,frame))
+   { current_node = frame.next->parent;
+     frame.next = frame.next->next_parent;
+     COUNT(COUNT_SCAN_VISIT);
+     if(PASS_MARK(current_node) == pass_counter)continue;
 
 /* If the node is covered by retained cubes, we can ignore it since it 
    does cut the interactions with the other cubes related to it. */
 
      if(current_node->status & COVERED) 
-      { current_node->count = pass_counter;
+      { PASS_MARK(current_node) = pass_counter;
         continue;
       }
 
 /* it is a undecided or inferior node it will be scanned for partition */
 
-     if(intersect_list(current_node->cube,save_current_node->uncovered))
-      { current_node->count = pass_counter;
+     if(intersect_list(current_node->cube,frame.node->uncovered))
+      { PASS_MARK(current_node) = pass_counter;
 	scan_count++;
-	scan_partition();
-      }
-   }
-	
-/* we will now scan its descendants to find uncovered nodes to scan */
-
-  temp_parent = save_current_node->descendants;
-
-  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
-   { current_node = temp_parent->parent;
-
-     if(current_node->count == pass_counter)continue;
-
-/* If the node is covered by retained cubes, we can ignore it since it 
-   does cut the interactions with the other cubes related to it. */
-
-     if(current_node->status & COVERED) 
-      { current_node->count = pass_counter;
-        continue;
-      }
-
-/* it is a undecided or inferior node it will be scanned for partition */
-
-     if(intersect_list(current_node->cube,save_current_node->uncovered))
-      { current_node->count = pass_counter;
-	scan_count++;
-        scan_partition();
+	SCAN_PUSH_BOTH(frame,current_node);
       }
    }
 }
@@ -705,66 +810,65 @@ AUTHOR
 
 *************************************************************************/
 
-scan_sparse_descendants()
+/* scan_sparse runs the sparse scan from the node given, on the list of
+   kind.								*/
+
+static scan_sparse(node,kind)
 
+struct node *node;
+int kind;
 {
-  struct parent *temp_parent;	/* parent to inspect */
+  struct scan_frame frame;	/* frame of the parent inspected */
 
-  temp_parent = current_node->descendants;
+  int base;			/* top of the work stack at the start */
 
-  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
-   { current_node = temp_parent->parent;
+  base = scan_top;
+  SCAN_ENTER(frame,node,kind);
+  while(frame.next != NULL || SCAN_POP(base,frame))
+   { current_node = frame.next->parent;
+     frame.next = frame.next->next_parent;
+     COUNT(COUNT_SCAN_VISIT);
+     if(frame.kind == SCAN_DESCENDANTS)
+      {
 
 /* we must check that we do not come back to either the calling node 
    or a node already scanned to avoid passing many times on some node on the 
    graph. 							*/
 
-     if((current_node->count | ONE) == odd_pass_counter)continue;
+	if((PASS_MARK(current_node) | ONE) == odd_pass_counter)continue;
 
 /* The node is retained, we will sharp it from the scanned cube */ 
 
-     if(current_node->status & RETAINED)
-      { (void)disjoint_sharp(&scanned_cube,current_node->cube);
-	current_node->count = pass_counter;
-	continue;
-      }
+	if(current_node->status & RETAINED)
+	 { (void)disjoint_sharp(&scanned_cube,current_node->cube);
+	   PASS_MARK(current_node) = pass_counter;
+	   continue;
+	 }
 
-     if(intersect_list(current_node->cube,scanned_cube))
-      { current_node->count = odd_pass_counter;
-	scan_sparse_descendants();
+	if(intersect_list(current_node->cube,scanned_cube))
+	 { PASS_MARK(current_node) = odd_pass_counter;
+	   SCAN_PUSH(frame,current_node,SCAN_DESCENDANTS);
+	 }
+	else PASS_MARK(current_node) = pass_counter;
+	continue;
       }
-     else current_node->count = pass_counter;
-   }
-}
-
-/****************************************************************************/
-
-scan_sparse_ancestors()
-
-{
-  struct parent *temp_parent;	/* parent to inspect */
-
-  temp_parent = current_node->ancestors;
-
-  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
-   { current_node = temp_parent->parent;
 
 /* we must check that we do not come back to either the calling node 
    or a node already scanned to avoid passing many times on some node on the 
    graph. 							*/
 
-     if(current_node->count == pass_counter)continue;
+     if(PASS_MARK(current_node) == pass_counter)continue;
 
 /* If the node was already scanned for descendants, we will also at this point
    scan its ancestors.						*/
 
-     if(current_node->count == odd_pass_counter)
-      { current_node->count = pass_counter;
-	scan_sparse_ancestors();
+     if(PASS_MARK(current_node) == odd_pass_counter)
+      { PASS_MARK(current_node) = pass_counter;
+	SCAN_PUSH(frame,current_node,SCAN_ANCESTORS);
         continue;
       }
 
-     current_node->count = pass_counter;
+     PASS_MARK(current_node) = pass_counter;
 
      if(current_node->status & RETAINED) 
       { (void)disjoint_sharp(&scanned_cube,current_node->cube);
@@ -772,10 +876,22 @@ scan_sparse_ancestors()
       }
 
      if(intersect_list(scanned_node->cube,current_node->uncovered))
-      { scan_sparse_ancestors();
-	current_node = temp_parent->parent;
-	scan_sparse_descendants();
-      }
+	SCAN_PUSH_BOTH(frame,current_node);
    }
 }
 
+/****************************************************************************/
+
+scan_sparse_descendants()
+
+{
+  scan_sparse(current_node,SCAN_DESCENDANTS);
+}
+
+/****************************************************************************/
+
+scan_sparse_ancestors()
+
+{
+  scan_sparse(current_node,SCAN_ANCESTORS);
+}
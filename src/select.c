@@ -274,3 +274,49 @@ struct branch *branch;
   common_list = merge_node_lists(branch->_.leaf,common_list);
 }
 
+
+/************************************************************************
+
+NAME
+	check_disjoint_input
+
+PURPOSE
+	The engines that do not partition the cubes on their inputs must
+	still refuse intersecting cubes when the user asked for disjoint
+	cubes at input.
+
+SYNOPSIS
+	check_disjoint_input(list)
+	struct node *list;
+
+DESCRIPTION
+	Each pair of cubes in the list is compared on its input part only.
+	When two cubes intersect, the first one is printed and the same
+	error as in select_input is generated.
+
+***************************************************************************/
+
+check_disjoint_input(list)
+
+struct node *list;
+{
+  struct node *temp_node;
+
+  long int result;
+
+  int i;
+
+  for(; list != NULL ; list = list->next_node)
+   { temp_node = list->next_node;
+     for(; temp_node != NULL ; temp_node = temp_node->next_node)
+      { for(i = 0 ; i < input_length ; i++)
+	 { result = list->cube[i] & temp_node->cube[i];
+	   if((((result >> 1) | result) & mask01) != mask01) break;
+	 }
+	if(i == input_length)
+	 { foutput_cube(stderr,list->cube);
+	   fatal_user_error("the part above is present in many cubes");
+	 }
+      }
+   }
+}
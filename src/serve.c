@@ -0,0 +1,502 @@
+/*********************************************************************
+
+NAME
+	serve_requests
+
+PURPOSE
+	Many small functions cost more to start the program, read its
+	switches and allocate its first blocks than to minimize. With
+	-serve the program stays up and minimizes the functions sent on a
+	Unix socket, by mcclient for instance.
+
+SYNOPSIS
+	serve_requests()
+
+DESCRIPTION
+	The socket serve_path is created and max_jobs workers are forked;
+	each of them accepts a connection, reads a request, sends back the
+	response and waits for the next connection. The first process only
+	starts a new worker when one ends, and on SIGINT or SIGTERM stops
+	the workers, removes the socket and exits.
+
+	A request is a line "MCBOOLE 1" followed by switches among -min,
+	-nint, -n, -b, -eng, -mem, -verify and -split with their values,
+	then the cubes as in an input file, up to the end of the data sent.
+	The response is a line "STATUS code bytes" followed by the bytes
+	of the output file. The code is 0 when the function was minimized
+	and the exit status of the program otherwise, for instance 1 when
+	the function read is wrong or the verification fails; the bytes
+	then hold the messages given.
+
+	The global variables of the program describe one function, so each
+	request is minimized by a process forked from the worker: it sets
+	the switches of the request with param over the switches of the
+	server, reads the cubes in memory and writes on a pipe read by the
+	worker. Nothing is started again but the fork, and a request
+	cannot leave anything behind for the next one.
+
+	Each worker keeps the responses of code 0 in memory, under a hash
+	of the whole request, and sends them again when the same request
+	comes; the responses used the least recently are dropped beyond
+	SERVE_CACHE_BYTES. The solutions can also be shared among the
+	workers, and kept between two servers, with -cache.
+
+*********************************************************************/
+
+#define _XOPEN_SOURCE 700
+
+#include "cubes.h"
+#include "param.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+
+#define SERVE_MAGIC "MCBOOLE 1"
+#define SERVE_MAX_REQUEST (256L << 20)	/* largest request read */
+#define SERVE_CACHE_BYTES (16L << 20)	/* responses kept by a worker */
+#define SERVE_MAX_SWITCHES 32		/* words on the request line */
+
+struct serve_entry
+ { unsigned long key[2];	/* hash of the request */
+   char *response;		/* response sent */
+   long length;			/* bytes in the response */
+   long used;			/* request count at the last use */
+ };
+
+extern FILE *input_file;
+
+extern struct parameter parmv[];
+
+extern int parmc;
+
+static char *serve_switches[] =	/* switches accepted in a request */
+ { "min", "nint", "n", "b", "eng", "mem", "verify", "split" };
+
+static char *serve_values[] =	/* switches followed by a value */
+ { "b", "eng", "mem" };
+
+static struct serve_entry *serve_cache;	/* responses of the worker */
+
+static int
+	cache_count,			/* responses in serve_cache */
+	cache_room;			/* entries allocated in serve_cache */
+
+static long
+	cache_bytes,			/* bytes of the responses kept */
+	request_count;			/* requests served by the worker */
+
+static volatile sig_atomic_t serve_stop = 0;	/* SIGINT or SIGTERM came */
+
+/***********************************************************************/
+
+static void serve_signal(sig)
+
+int sig;
+{
+  serve_stop = 1;
+}
+
+/***********************************************************************/
+
+/* write_all writes the whole buffer on a descriptor, 0 on failure */
+
+static int write_all(fd,buffer,length)
+
+int fd;
+char *buffer;
+long length;
+{
+  long done;
+
+  while(length > 0)
+   { done = write(fd,buffer,(size_t)length);
+     if(done < 0 && errno == EINTR) continue;
+     if(done <= 0) return(0);
+     buffer += done;
+     length -= done;
+   }
+  return(1);
+}
+
+/***********************************************************************/
+
+/* read_all reads a descriptor up to its end in a buffer allocated, and
+   returns the bytes read or -1 beyond limit bytes.			*/
+
+static long read_all(fd,buffer,limit)
+
+int fd;
+char **buffer;
+long limit;
+{
+  long length,room,done;
+
+  length = 0;
+  room = 4096;
+  *buffer = (char *)malloc((size_t)room + 1);
+  if(*buffer == NULL) fatal_system_error("unable to alloc a request");
+  for(;;)
+   { if(length == room)
+      { room *= 2;
+	*buffer = (char *)realloc(*buffer,(size_t)room + 1);
+	if(*buffer == NULL) fatal_system_error("unable to alloc a request");
+      }
+     done = read(fd,*buffer + length,(size_t)(room - length));
+     if(done < 0 && errno == EINTR) continue;
+     if(done <= 0) break;
+     length += done;
+     if(length > limit) return(-1);
+   }
+  (*buffer)[length] = '\0';
+  return(length);
+}
+
+/***********************************************************************/
+
+/* request_key hashes the request in key */
+
+static request_key(request,length,key)
+
+char *request;
+long length;
+unsigned long *key;
+{
+  long i;
+
+  key[0] = 0xcbf29ce484222325UL;
+  key[1] = 0x84222325cbf29ce4UL;
+  for(i = 0 ; i < length ; i++)
+   { key[0] = (key[0] ^ (unsigned char)request[i]) * 0x100000001b3UL;
+     key[1] = (key[1] + (unsigned char)request[i]) * 0xff51afd7ed558ccdUL;
+   }
+}
+
+/***********************************************************************/
+
+/* find_response returns the response kept for a key, or NULL */
+
+static struct serve_entry *find_response(key)
+
+unsigned long *key;
+{
+  int i;
+
+  for(i = 0 ; i < cache_count ; i++)
+   { if(serve_cache[i].key[0] == key[0] && serve_cache[i].key[1] == key[1])
+      { serve_cache[i].used = request_count;
+	return(serve_cache + i);
+      }
+   }
+  return(NULL);
+}
+
+/***********************************************************************/
+
+/* keep_response adds a response to the worker cache, dropping the oldest
+   ones beyond SERVE_CACHE_BYTES.					*/
+
+static keep_response(key,response,length)
+
+unsigned long *key;
+char *response;
+long length;
+{
+  int i,oldest;
+
+  if(length > SERVE_CACHE_BYTES / 4) return;
+  while(cache_count > 0 && cache_bytes + length > SERVE_CACHE_BYTES)
+   { oldest = 0;
+     for(i = 1 ; i < cache_count ; i++)
+      { if(serve_cache[i].used < serve_cache[oldest].used) oldest = i;
+      }
+     cache_bytes -= serve_cache[oldest].length;
+     free(serve_cache[oldest].response);
+     serve_cache[oldest] = serve_cache[--cache_count];
+   }
+  if(cache_count == cache_room)
+   { cache_room = cache_room ? 2 * cache_room : 64;
+     serve_cache = (struct serve_entry *)realloc((char *)serve_cache,
+		(unsigned)cache_room * sizeof(struct serve_entry));
+     if(serve_cache == NULL) fatal_system_error("unable to alloc the cache");
+   }
+  serve_cache[cache_count].response = (char *)malloc((size_t)length);
+  if(serve_cache[cache_count].response == NULL) return;
+  memcpy(serve_cache[cache_count].response,response,(size_t)length);
+  serve_cache[cache_count].key[0] = key[0];
+  serve_cache[cache_count].key[1] = key[1];
+  serve_cache[cache_count].length = length;
+  serve_cache[cache_count].used = request_count;
+  cache_bytes += length;
+  cache_count++;
+}
+
+/***********************************************************************/
+
+/* request_switches cuts the request line in words for param, and returns
+   their number, or -1 when a switch is not accepted.			*/
+
+static int request_switches(line,argv)
+
+char *line,**argv;
+{
+  char *word;
+
+  int argc,i,value;
+
+  argc = 0;
+  argv[argc++] = "mcboole";
+  value = 0;
+  for(word = strtok(line," \t\r") ; word != NULL ; word = strtok(NULL," \t\r"))
+   { if(argc == SERVE_MAX_SWITCHES - 1) return(-1);
+     if(value)
+      { argv[argc++] = word;
+	value = 0;
+	continue;
+      }
+     if(word[0] != '-') return(-1);
+     for(i = 0 ; i < sizeof(serve_switches) / sizeof(char *) ; i++)
+      { if(strcmp(word + 1,serve_switches[i]) == 0) break;
+      }
+     if(i == sizeof(serve_switches) / sizeof(char *)) return(-1);
+     for(i = 0 ; i < sizeof(serve_values) / sizeof(char *) ; i++)
+      { if(strcmp(word + 1,serve_values[i]) == 0) value = 1;
+      }
+     argv[argc++] = word;
+   }
+  if(value) return(-1);
+  argv[argc] = NULL;
+  return(argc);
+}
+
+/***********************************************************************/
+
+/* make_response returns the response of a status and of the bytes given,
+   with its length.							*/
+
+static char *make_response(status,body,body_length,response_length)
+
+int status;
+char *body;
+long body_length,*response_length;
+{
+  char header[64],*response;
+
+  sprintf(header,"STATUS %d %ld\n",status,body_length);
+  *response_length = strlen(header) + body_length;
+  response = (char *)malloc((size_t)*response_length);
+  if(response == NULL) fatal_system_error("unable to alloc a response");
+  strcpy(response,header);
+  memcpy(response + strlen(header),body,(size_t)body_length);
+  return(response);
+}
+
+/***********************************************************************/
+
+/* minimize_request minimizes the function of a request in a process
+   forked, and returns the response with its length.			*/
+
+static char *minimize_request(request,length,response_length)
+
+char *request;
+long length,*response_length;
+{
+  char *argv[SERVE_MAX_SWITCHES],*body,*output,*response;
+
+  int response_pipe[2],argc,status,j;
+
+  long output_length;
+
+  pid_t pid;
+
+  body = strchr(request,'\n');
+  if(strncmp(request,SERVE_MAGIC,strlen(SERVE_MAGIC)) != 0 || body == NULL)
+   { output = "McBOOLE : the request does not begin with MCBOOLE 1\n";
+     return(make_response(2,output,(long)strlen(output),response_length));
+   }
+
+  if(pipe(response_pipe) != 0) fatal_system_error("unable to create a pipe");
+  pid = fork();
+  if(pid < 0) fatal_system_error("unable to fork a request");
+  if(pid == 0)
+   {
+
+/* the process of the request reads nothing on stdin, where param would
+   ask again for a wrong value, and writes all it prints on the pipe; the
+   files and the switches of the server only giving news are not its own.
+									*/
+
+     close(response_pipe[0]);
+     j = open("/dev/null",O_RDONLY);
+     if(j >= 0) dup2(j,0);
+     dup2(response_pipe[1],1);
+     dup2(response_pipe[1],2);
+     close(response_pipe[1]);
+     signal(SIGPIPE,SIG_DFL);
+     *body++ = '\0';
+     argc = request_switches(request + strlen(SERVE_MAGIC),argv);
+     if(argc < 0) fatal_user_error("a switch of the request is not accepted");
+     for(j = 0 ; j < parmc ; j++) parmv[j].flag &= ~P_PRESENT;
+     param(parmc,parmv,argc,argv);
+     quiet_child(0);
+     serve_path = "";
+     save_primes_path = load_primes_path = "";
+     input_file = fmemopen(body,(size_t)(length - (body - request)),"r");
+     if(input_file == NULL) fatal_user_error("the request holds no cube");
+     output_file = stdout;
+     minimize();
+     exit(0);
+   }
+
+  close(response_pipe[1]);
+  output_length = read_all(response_pipe[0],&output,SERVE_MAX_REQUEST);
+  close(response_pipe[0]);
+  while(waitpid(pid,&status,0) < 0 && errno == EINTR);
+  status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+  if(output_length < 0)
+   { free(output);
+     output = "McBOOLE : the response is too large\n";
+     return(make_response(2,output,(long)strlen(output),response_length));
+   }
+  response = make_response(status,output,output_length,response_length);
+  free(output);
+  return(response);
+}
+
+/***********************************************************************/
+
+/* serve_worker answers the connections of the socket until the server
+   stops it.								*/
+
+static serve_worker(listen_fd)
+
+int listen_fd;
+{
+  struct serve_entry *entry;
+
+  struct timespec start,end;
+
+  unsigned long key[2];
+
+  char *request,*response;
+
+  long length,response_length;
+
+  int fd,from_cache;
+
+  signal(SIGINT,SIG_DFL);
+  signal(SIGTERM,SIG_DFL);
+  for(;;)
+   { fd = accept(listen_fd,(struct sockaddr *)NULL,(socklen_t *)NULL);
+     if(fd < 0)
+      { if(errno == EINTR || errno == ECONNABORTED) continue;
+	fatal_system_error("unable to accept a connection");
+      }
+     clock_gettime(CLOCK_MONOTONIC,&start);
+     request_count++;
+     length = read_all(fd,&request,SERVE_MAX_REQUEST);
+     if(length < 0)
+      { response = "McBOOLE : the request is too large\n";
+	response = make_response(2,response,(long)strlen(response),
+				 &response_length);
+	(void)write_all(fd,response,response_length);
+	free(response);
+	free(request);
+	close(fd);
+	continue;
+      }
+     request_key(request,length,key);
+     entry = find_response(key);
+     from_cache = entry != NULL;
+     if(from_cache) (void)write_all(fd,entry->response,entry->length);
+     else
+      { response = minimize_request(request,length,&response_length);
+	(void)write_all(fd,response,response_length);
+	if(strncmp(response,"STATUS 0 ",9) == 0)
+	   keep_response(key,response,response_length);
+	free(response);
+      }
+     free(request);
+     close(fd);
+     if(VERBOSIS)
+      { clock_gettime(CLOCK_MONOTONIC,&end);
+	sprintf(error_buffer,"worker %ld request %ld, %ld bytes, %.3f ms%s",
+		(long)getpid(),request_count,length,
+		(end.tv_sec - start.tv_sec) * 1e3 +
+		(end.tv_nsec - start.tv_nsec) / 1e6,
+		from_cache ? ", from the cache" : "");
+	send_user_message(error_buffer);
+	fflush(stdout);
+      }
+   }
+}
+
+/***********************************************************************/
+
+serve_requests()
+
+{
+  struct sockaddr_un address;
+
+  struct sigaction action;
+
+  pid_t *worker,pid;
+
+  int listen_fd,i;
+
+  listen_fd = socket(AF_UNIX,SOCK_STREAM,0);
+  if(listen_fd < 0) fatal_system_error("unable to create the socket");
+  memset((char *)&address,0,sizeof(address));
+  address.sun_family = AF_UNIX;
+  if(strlen(serve_path) >= sizeof(address.sun_path))
+	fatal_user_error("the socket path is too long");
+  strcpy(address.sun_path,serve_path);
+  (void)unlink(serve_path);
+  if(bind(listen_fd,(struct sockaddr *)&address,sizeof(address)) != 0 ||
+     listen(listen_fd,64) != 0)
+	fatal_system_error("unable to bind the socket");
+
+  memset((char *)&action,0,sizeof(action));
+  action.sa_handler = serve_signal;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT,&action,(struct sigaction *)NULL);
+  sigaction(SIGTERM,&action,(struct sigaction *)NULL);
+  signal(SIGPIPE,SIG_IGN);
+
+  worker = (pid_t *)calloc((unsigned)max_jobs,sizeof(pid_t));
+  if(worker == NULL) fatal_system_error("unable to alloc the workers");
+  sprintf(error_buffer,"serving on %s with %d workers",serve_path,max_jobs);
+  send_user_message(error_buffer);
+  fflush(stdout);
+
+/* a worker which ends is replaced, until the server is stopped */
+
+  for(;;)
+   { for(i = 0 ; i < max_jobs && serve_stop == 0 ; i++)
+      { if(worker[i] != 0) continue;
+	worker[i] = fork();
+	if(worker[i] < 0) fatal_system_error("unable to fork a worker");
+	if(worker[i] == 0) serve_worker(listen_fd);
+      }
+     pid = wait((int *)NULL);
+     if(serve_stop) break;
+     for(i = 0 ; i < max_jobs ; i++)
+      { if(worker[i] == pid) worker[i] = 0;
+      }
+   }
+
+  for(i = 0 ; i < max_jobs ; i++)
+   { if(worker[i] > 0) kill(worker[i],SIGTERM);
+   }
+  while(wait((int *)NULL) > 0 || errno == EINTR);
+  close(listen_fd);
+  (void)unlink(serve_path);
+  exit(0);
+}
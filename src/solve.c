@@ -1,5 +1,15 @@
+#ifdef PARALLEL
+#define _POSIX_C_SOURCE 200112L
+#endif
+
 #include "cubes.h"
+#include "trace.h"
 #include <stdlib.h>
+#include <string.h>
+
+#ifdef PARALLEL
+#include <pthread.h>
+#endif
 
 /***********************************************************************
 
@@ -19,7 +29,9 @@ DESCRIPTION
 	This function puts all the prime implicants in a vector, finds
 	the essential prime implicants and then finds the best
 	set of cubes to cover the function. The nodes are ordered in
-	the vector with the retained first.
+	the vector with the retained first. With -branch time, the
+	branching rule is first chosen by time_branch_rules; with -branch
+	portfolio, the covering is done by portfolio_covering.
 
 COORDINATES
 	McGill University Electrical Engineering MONTREAL CANADA
@@ -52,10 +64,17 @@ int
 	branching_depth;	/* depth in recursion while branching */
 
 unsigned long int
-	ONE = 1,		/* a constant 1 unsigned long int */
+	ONE = 1;		/* a constant 1 unsigned long int */
+
+unsigned int
+	*pass_mark = NULL,	/* pass count when each node was last visited */
 	odd_pass_counter,	/* pass counter + 1 to identify scanning dir.*/
 	pass_counter;		/* counts the number of scanning pass */
 
+static long
+	vector_charge = 0,	/* memory charged for prime_nodes and the stack */
+	mark_charge = 0;	/* memory charged for pass_mark */
+
 
 find_best_covering(list)
 
@@ -68,6 +87,23 @@ struct node *list;
 
   struct node **cursor;		/* pointer in the vector of nodes */
   
+/* with -branch portfolio workers cover the list in children; with -branch
+   time each rule is tried in a child on a copy of the list, for each
+   function covered.							*/
+
+  if(strcmp(branch_rule,"portfolio") == 0)
+   { portfolio_covering(list);
+     return;
+   }
+  if(strcmp(branch_rule,"time") == 0)
+	branch_rule_number = time_branch_rules(list);
+  if(branch_rule_number != 0)
+   { sprintf(error_buffer,"Branching rule : %s",
+	     branch_rules[branch_rule_number].name);
+     if(VERBOSIS)send_user_dtime(error_buffer);
+     send_file_dtime(error_buffer);
+   }
+
 /* we will now compute the cost of the cubes in the list. The cost is defined
    as the number of non x inputs. Also a cube list is allocated for each node
    containing the uncovered part of the node; at the beginning, the whole node
@@ -94,10 +130,12 @@ struct node *list;
   prime_nodes = (struct node **)
 			calloc((unsigned)prime_count,sizeof(struct node *));
   if(prime_nodes == NULL)fatal_system_error("unable to allocate prime_nodes");
+  charge_memory((long)prime_count * sizeof(struct node *));
   cursor = prime_nodes;
   scanned_node = list;
   for(; scanned_node != NULL ; scanned_node = scanned_node->next_node)
-   { *cursor = scanned_node;
+   { scanned_node->id = cursor - prime_nodes;
+     *cursor = scanned_node;
      cursor++;
    }
   retained_nodes = prime_nodes;
@@ -111,28 +149,54 @@ struct node *list;
   start_stack = (struct node **)
 			calloc((unsigned)prime_count,sizeof(struct node *));
   if(start_stack == NULL)fatal_system_error("unable to allocate stack");
+  charge_memory((long)prime_count * sizeof(struct node *));
+  vector_charge = 2L * prime_count * sizeof(struct node *);
   end_stack = start_stack + prime_count;
   current_in_stack = start_stack;
 
+/* the pass count of each node is kept in a vector indexed by its id, so
+   that the nodes scanned are not written and a new count is a reset of
+   the vector only. The vector is kept from a covering to the next and
+   only its new size is charged.					*/
+
+  pass_mark = (unsigned int *)realloc((char *)pass_mark,
+			(unsigned)(prime_count + 1) * sizeof(unsigned int));
+  if(pass_mark == NULL)fatal_system_error("unable to allocate pass marks");
+  release_memory(mark_charge);
+  mark_charge = (long)prime_count * sizeof(unsigned int);
+  charge_memory(mark_charge);
+  init_scan_stack();
+
+  init_node_scores();
+  open_checkpoint();
+
   sprintf(error_buffer,"The function has %d prime implicants",prime_care);
   if(VERBOSIS)send_user_dtime(error_buffer);
   send_file_dtime(error_buffer);
 
 /* we first extract from the list the essential prime implicants */
 
-  pass_counter = 0;
+  init_pass_count();
 
 #ifdef CHECK
   check_graph();
 #endif
 
   scan_count = 0;
+  profile_begin(PHASE_EPI);
   essential_prime_implicants();
+  profile_end(PHASE_EPI);
 
   sprintf(error_buffer,"The function has %d essential PI",scan_count);
   if(VERBOSIS)send_user_dtime(error_buffer);
   send_file_dtime(error_buffer);
 
+/* with -resume, the nodes retained by the run stopped are retained again,
+   and with a delta, the nodes of the previous cover it does not reach. */
+
+  if(RESUME_COVERING) resume_checkpoint();
+  reuse_previous_cover(list);
+
 /* we are ready now to call the recursive function to find the best solution
    branching if needed. We have first to define that we are now at branching
    depth 0 here. Also we initialize the pass counter to 0 since all the flags
@@ -140,7 +204,10 @@ struct node *list;
 
   branching_depth = 0;
   max_branching_depth = 0;
+  profile_begin(PHASE_BRANCH);
   recursive_find_covering();
+  profile_end(PHASE_BRANCH);
+  close_checkpoint();
 
 
 /* the solution is reached, the retained nodes in the final solution are in the
@@ -149,7 +216,9 @@ struct node *list;
    the output part of each of the retained cubes irredundant in the sense
    that no 1 at output can be removed without changing the the function. */
 
+  profile_begin(PHASE_SPARSE);
   make_output_sparse();
+  profile_end(PHASE_SPARSE);
   sprintf(error_buffer,"The solution contains %d nodes",(int)(retained_nodes -
 							    prime_nodes));
   if(VERBOSIS)send_user_dtime(error_buffer);
@@ -171,6 +240,271 @@ struct node *list;
 
 /************************************************************************
 
+NAME
+	free_covering
+
+PURPOSE
+	When several functions are covered in turn, as the components of
+	-split, the graph of each one is released once its solution is
+	copied.
+
+SYNOPSIS
+	free_covering()
+
+DESCRIPTION
+	The nodes of the vector prime_nodes up to end_prime are freed with
+	their links and their uncovered cubes, then the vector and the
+	stack are freed and the memory charged for them is released. The
+	vector may come from find_best_covering, from the cache or from
+	portfolio_covering.
+
+***************************************************************************/
+
+free_covering()
+
+{
+  struct node **cursor;		/* pointer in the vector of nodes */
+
+  for(cursor = prime_nodes ; cursor < end_prime ; cursor++)
+   { free_list_of_parents(&(*cursor)->ancestors);
+     free_list_of_parents(&(*cursor)->descendants);
+     free_list_of_cubes(&(*cursor)->uncovered);
+     free_node(*cursor);
+   }
+  free((char *)prime_nodes);
+  prime_nodes = retained_nodes = unretain_nodes = end_prime = NULL;
+  if(start_stack != NULL) free((char *)start_stack);
+  start_stack = end_stack = current_in_stack = NULL;
+  release_memory(vector_charge);
+  vector_charge = 0;
+}
+
+/************************************************************************
+
+NAME
+	find_essential_nodes
+
+PURPOSE
+	Find which basic nodes are essential, without changing anything
+	else in the graph, so that the nodes can be examined concurrently.
+
+SYNOPSIS
+	find_essential_nodes()
+
+DESCRIPTION
+	For each basic node between retained_nodes and unretain_nodes, the
+	part of its cube not covered by its ancestors and descendants is
+	computed by disjoint sharp. When something remains the node is
+	essential and ESSENTIAL_FOUND is set in its status.
+
+	The sharp is done in a sharp_arena, two vectors of cubes used in
+	turn as source and destination, instead of the cube lists of the
+	common pool. Each thread has its own arena and only writes the
+	status of the nodes it examines. When compiled with PARALLEL and
+	more than one job is allowed with -j, the vector is shared among
+	max_jobs threads, node i going to thread i modulo max_jobs.
+
+***************************************************************************/
+
+struct essential_job
+ { struct node **first;		/* first node examined by the job */
+   struct node **end;		/* end of the nodes examined */
+   int step;			/* distance between two nodes examined */
+#ifdef COUNTERS
+   long splits;			/* cubes split by the sharps of the job */
+#endif
+ };
+
+/***********************************************************************/
+
+/* arena_push returns the place of a new cube in one side of the arena */
+
+long int *arena_push(arena,side)
+
+struct sharp_arena *arena;
+int side;
+{
+  if(arena->count[side] == arena->size[side])
+   { arena->size[side] = arena->size[side] ? 2 * arena->size[side] : 64;
+     arena->cube[side] = (long int *)realloc((char *)arena->cube[side],
+	(unsigned)(arena->size[side] * total_length) * sizeof(long int));
+     if(arena->cube[side] == NULL)
+	fatal_system_error("unable to alloc sharp arena");
+   }
+  return(arena->cube[side] + total_length * arena->count[side]++);
+}
+
+/***********************************************************************/
+
+/* arena_sharp removes the cube from the current cubes of the arena, as
+   disjoint_sharp does for a list, and returns 1 when nothing remains. */
+
+int arena_sharp(arena,cube)
+
+struct sharp_arena *arena;
+long int *cube;
+{
+  long int
+	*present_cube,	/* cube of the source side */
+	*piece,		/* part of the cube disjoint from the sharping cube */
+	result,		/* part of a word not in the sharping cube */
+	mask_var;	/* mask one variable in a long int */
+
+  int in,out,i,j,nonzero;
+
+  in = arena->side;
+  out = 1 - in;
+  arena->count[out] = 0;
+  for(i = 0 ; i < arena->count[in] ; i++)
+   { present_cube = arena->cube[in] + total_length * i;
+     if(intersect(cube,present_cube) == 0)
+      { copy_cube(present_cube,arena_push(arena,out));
+	continue;
+      }
+
+/* the cube is split on each input where it has an x and the sharping cube
+   does not; the pieces disjoint from the sharping cube are kept.     */
+
+     for(j = 0 ; j < input_length ; j++)
+      { result = (cube[j] & present_cube[j]) ^ present_cube[j];
+	for(mask_var = 3 ; result != 0 && mask_var != 0 ; mask_var <<= 2)
+	 { if(result & mask_var)
+	    {
+#ifdef COUNTERS
+	      arena->splits++;
+#endif
+	      piece = arena_push(arena,out);
+	      copy_cube(present_cube,piece);
+	      piece[j] = ~(mask_var & cube[j]) & present_cube[j];
+	      present_cube[j] = (~mask_var | cube[j]) & present_cube[j];
+	    }
+	 }
+      }
+
+/* what is left is covered at input, the common outputs are removed */
+
+     nonzero = 0;
+     for(; j < total_length ; j++)
+      { present_cube[j] &= ~cube[j];
+	if(present_cube[j]) nonzero = 1;
+      }
+     if(nonzero) copy_cube(present_cube,arena_push(arena,out));
+   }
+  arena->side = out;
+  return(arena->count[out] == 0);
+}
+
+/***********************************************************************/
+
+/* node_is_essential tells if some part of the node is covered by none
+   of its ancestors and descendants.					*/
+
+static int node_is_essential(node,arena)
+
+struct node *node;
+struct sharp_arena *arena;
+{
+  struct parent *temp_parent;	/* temp parent in a parent list */
+
+  arena->side = 0;
+  arena->count[0] = 0;
+  copy_cube(node->cube,arena_push(arena,0));
+
+  temp_parent = node->ancestors;
+  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
+   { if(arena_sharp(arena,temp_parent->parent->cube)) return(0);
+   }
+  temp_parent = node->descendants;
+  for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
+   { if(arena_sharp(arena,temp_parent->parent->cube)) return(0);
+   }
+  return(1);
+}
+
+/***********************************************************************/
+
+static char *essential_worker(job)
+
+struct essential_job *job;
+{
+  struct sharp_arena arena;	/* cubes of this job */
+
+  struct node **cursor,*node;
+
+  arena.cube[0] = arena.cube[1] = NULL;
+  arena.size[0] = arena.size[1] = 0;
+#ifdef COUNTERS
+  arena.splits = 0;
+#endif
+  for(cursor = job->first ; cursor < job->end ; cursor += job->step)
+   { if(job->first == retained_nodes) PROGRESS();
+     node = *cursor;
+     if((node->status & (BASIC | DONT_CARE)) == BASIC &&
+	node_is_essential(node,&arena))
+	node->status |= ESSENTIAL_FOUND;
+   }
+#ifdef COUNTERS
+  job->splits = arena.splits;
+#endif
+  if(arena.cube[0] != NULL) free((char *)arena.cube[0]);
+  if(arena.cube[1] != NULL) free((char *)arena.cube[1]);
+  return(NULL);
+}
+
+/***********************************************************************/
+
+find_essential_nodes()
+
+{
+  struct essential_job job;	/* the job done by this thread */
+
+#ifdef PARALLEL
+  struct essential_job *jobs;	/* the job of each thread */
+
+  pthread_t *threads;
+
+  int i,nb_threads;
+
+  nb_threads = max_jobs;
+  if(nb_threads > unretain_nodes - retained_nodes)
+	nb_threads = unretain_nodes - retained_nodes;
+  if(nb_threads > 1)
+   { jobs = (struct essential_job *)
+		calloc((unsigned)nb_threads,sizeof(struct essential_job));
+     threads = (pthread_t *)calloc((unsigned)nb_threads,sizeof(pthread_t));
+     if(jobs == NULL || threads == NULL)
+	fatal_system_error("unable to alloc essential jobs");
+     for(i = 0 ; i < nb_threads ; i++)
+      { jobs[i].first = retained_nodes + i;
+	jobs[i].end = unretain_nodes;
+	jobs[i].step = nb_threads;
+	if(pthread_create(threads + i,NULL,
+		(void *(*)())essential_worker,(void *)(jobs + i)) != 0)
+	    fatal_system_error("unable to create an essential thread");
+      }
+     for(i = 0 ; i < nb_threads ; i++)
+      { pthread_join(threads[i],NULL);
+#ifdef COUNTERS
+	op_counter[COUNT_SHARP_SPLIT] += jobs[i].splits;
+#endif
+      }
+     free((char *)jobs);
+     free((char *)threads);
+     return;
+   }
+#endif
+
+  job.first = retained_nodes;
+  job.end = unretain_nodes;
+  job.step = 1;
+  (void)essential_worker(&job);
+#ifdef COUNTERS
+  op_counter[COUNT_SHARP_SPLIT] += job.splits;
+#endif
+}
+
+/************************************************************************
+
 NAME
 	essential_prime_implicants
 
@@ -186,6 +520,13 @@ DESCRIPTION
 	to determine which are prime essential implicants. The prime
 	essential implicants are then retained.
 
+	Whether a node is essential depends only on its cube and on the
+	cubes of its ancestors and descendants, not on the decisions taken
+	for other nodes. It is thus first computed for all the basic nodes,
+	by find_essential_nodes, in parallel when allowed, and the nodes
+	found are marked ESSENTIAL_FOUND. The vector is then scanned in the
+	same order as before to retain them.
+
 COORDINATES
 	McGill University Electrical Engineering VLSI lab MONTREAL CANADA
 	16 july 1984
@@ -199,12 +540,14 @@ essential_prime_implicants()
 
 {
   struct node **cursor;		/* pointer in the vector of nodes */ 
- 
-  struct parent *temp_parent;	/* temp parent in a parent list */
 
+  int essential;		/* the node was found essential */
+
+  find_essential_nodes();
   cursor = retained_nodes;
   for(; cursor < unretain_nodes ; cursor++)
-   { scanned_node = *cursor;
+   { PROGRESS();
+     scanned_node = *cursor;
 
      if(scanned_node->status & DONT_CARE)
       { scanned_cube = NULL;
@@ -220,29 +563,15 @@ essential_prime_implicants()
 
      if((scanned_node->status & BASIC) == 0) continue;
 
+     essential = scanned_node->status & ESSENTIAL_FOUND;
      scanned_node->status &= NOT_BASIC;
-     scanned_cube = copy_and_alloc_cube_list(scanned_node->cube);
-     temp_parent = scanned_node->ancestors;
-
-/* we remove from cube the part covered by its ancestors */
-
-     for(; temp_parent != NULL ; temp_parent = temp_parent->next_parent)
-      { (void)disjoint_sharp(&scanned_cube,temp_parent->parent->cube);
-      }
-
-     temp_parent = scanned_node->descendants;
-
-/* we see if the remaining part is covered by its descendants */
-
-     for(;temp_parent != NULL ;temp_parent = temp_parent->next_parent)
-	 { if(disjoint_sharp(&scanned_cube,temp_parent->parent->cube))break;
-	 }
 
 /* The node is essential it will be retained because it is necessarily part
    of the optimal solution.						*/
 
-     if(scanned_cube != NULL) 
-      { scan_count++;
+     if(essential) 
+      { scanned_cube = NULL;
+	scan_count++;
 
 #ifdef CHECK 
 	retain_check_node();
@@ -318,13 +647,17 @@ recursive_find_covering()
 	*branching_node;		/* node choosen to branch on */
 
   int 
-	partition_count;	/* number of nodes in save partition */
+	partition_count,	/* number of nodes in save partition */
+	cut;			/* the side retaining the node is not solved */
+
+  struct trace_record record;	/* decision written in the trace file */
 
 /* We scan all the affected nodes in the stack until it is empty, at this
    point either we have the final solution or we have a cycle */
 
   for(scanned_node = pop() ; ; scanned_node = pop())
-   { if(scanned_node == NULL)
+   { PROGRESS();
+     if(scanned_node == NULL)
 
 /* there is no more affected nodes in the stack, we either have a cycle
    or the final solution; We will first order the nodes in the vector
@@ -349,17 +682,31 @@ recursive_find_covering()
 
         if(scan_count == 0) return;
 
-/* We have a cycle, if the branching depth reached the limit, we will simply
-   pick a node and continue in the loop.			*/
+/* We have a cycle, if the branching depth or the memory budget reached the
+   limit, we will simply pick a node and continue in the loop.	*/
 
 #ifdef CHECK 
         check_cycle();
 #endif
-	if(branching_depth >= depth_limit)
+	if(branching_depth >= depth_limit || memory_exceeded)
 	 { select_node();
+	   if(trace_file != NULL)
+	    { memset((char *)&record,0,sizeof(record));
+	      record.kind = TRACE_FORCED;
+	      record.depth = branching_depth;
+	      record.partition = scan_count;
+	      record.node = scanned_node->id;
+	      record.score = select_score;
+	      record.node_cost = scanned_node->cost;
+	      write_trace(&record);
+	    }
 	   scanned_cube = NULL;
 	   retain_node();
 	   if(max_branching_depth < INFINITY) max_branching_depth = INFINITY;
+	   if(branching_depth == 0)
+	    { save_checkpoint();
+	      portfolio_bound();
+	    }
 	   continue;
 	 }
 
@@ -374,6 +721,7 @@ recursive_find_covering()
      if(scanned_node->status & AFFECTED_RETAINED)
       { if(scanned_node->uncovered == NULL)
 	 { scanned_node->status = DECIDED_COVERED;
+	   touch_node(scanned_node);
 	   continue;
 	 }
 	current_node = scanned_node;
@@ -437,16 +785,23 @@ recursive_find_covering()
    be stored for branching.						*/
 
      partition_count = scan_count;
+     if(trace_file != NULL)
+      { memset((char *)&record,0,sizeof(record));
+	record.kind = TRACE_BRANCHED;
+	record.partition = partition_count;
+	record.seconds = trace_clock();
+      }
      save_partition = (struct save_status *)calloc((unsigned)partition_count,
 						sizeof(struct save_status));
      if(save_partition == NULL)fatal_system_error("unable to alloc partition");
+     charge_memory((long)partition_count * sizeof(struct save_status));
      cursor_partition = save_partition;
      cursor = retained_nodes;
      partition_nodes = retained_nodes;
 
      for(; cursor < unretain_nodes ;)
       { scanned_node = *cursor;
-	if(scanned_node->count == pass_counter)
+	if(PASS_MARK(scanned_node) == pass_counter)
 	 { cursor_partition->node = scanned_node;
 	   cursor_partition->status = scanned_node->status;
 	   cursor_partition->uncovered = 
@@ -480,6 +835,7 @@ recursive_find_covering()
 
      select_node();
      branching_node = scanned_node;
+     record.score = select_score;
      if(VERBOSIS)send_user_message("a node is unretain for branching");
      unretain_inferior_node();
 
@@ -503,6 +859,7 @@ recursive_find_covering()
 	cursor_partition->uncovered = scanned_node->uncovered;
 	scanned_node->uncovered = scanned_cube;
 	scanned_node->status = temp_status;
+	touch_node(scanned_node);
       }
 
 /* We now have to reset the pointers in the prime node vector to their 
@@ -511,11 +868,19 @@ recursive_find_covering()
 
      retained_nodes = save_retained_nodes;
      unretain_nodes = partition_nodes;
-     scanned_node = branching_node;
-     scanned_cube = NULL;
-     if(VERBOSIS)send_user_message("a node is retained for branching"); 
-     retain_node();
-     recursive_find_covering();
+
+/* a portfolio worker does not solve this side when the nodes retained
+   and the branching node are already more than the best solution of
+   the other workers.							*/
+
+     cut = portfolio_cut((int)(save_retained_nodes - prime_nodes) + 1);
+     if(cut == 0)
+      { scanned_node = branching_node;
+	scanned_cube = NULL;
+	if(VERBOSIS)send_user_message("a node is retained for branching"); 
+	retain_node();
+	recursive_find_covering();
+      }
 
 /* Having both solutions we can now compute their cost and compare them  */
 
@@ -537,6 +902,21 @@ recursive_find_covering()
 	   unretain_cost += scanned_node->cost;
 	 }
       }
+     if(cut) retain_count = INFINITY;
+
+     if(trace_file != NULL)
+      { record.depth = branching_depth;
+	record.node = branching_node->id;
+	record.node_cost = branching_node->cost;
+	record.retain_count = retain_count;
+	record.retain_cost = retain_cost;
+	record.unretain_count = unretain_count;
+	record.unretain_cost = unretain_cost;
+	record.kept = retain_count > unretain_count ||
+		(retain_count == unretain_count && retain_cost > unretain_cost);
+	record.seconds = trace_clock() - record.seconds;
+	write_trace(&record);
+      }
 
      if(retain_count == unretain_count)
       { if(retain_cost < unretain_cost) unretain_count = INFINITY;
@@ -558,6 +938,7 @@ recursive_find_covering()
 	    }
 	   scanned_node->uncovered = cursor_partition->uncovered;
 	   scanned_node->status = cursor_partition->status;
+	   touch_node(scanned_node);
          }
       }
 
@@ -584,10 +965,20 @@ recursive_find_covering()
    their proper place in the vector.					*/
 
      free((char *)save_partition);
+     release_memory((long)partition_count * sizeof(struct save_status));
      retained_nodes = save_retained_nodes;
      unretain_nodes = save_unretain_nodes;
 
      place_nodes_in_vector();
+
+/* the partitions solved at the first depth are not reconsidered, the
+   nodes retained so far can be kept in the checkpoint, and a portfolio
+   worker already worse than the best solution found can stop.	*/
+
+     if(branching_depth == 1)
+      { save_checkpoint();
+	portfolio_bound();
+      }
    }
 
 /* the solution is finally obtained at this level, we will reset the branching
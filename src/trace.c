@@ -0,0 +1,80 @@
+/*********************************************************************
+
+NAME
+	trace_clock, write_trace, close_trace
+
+PURPOSE
+	Keep a record of each decision taken on a cycle by the covering,
+	to study offline where the branching spends its time and how well
+	select_node chooses.
+
+SYNOPSIS
+	double trace_clock()
+
+	write_trace(record)
+	struct trace_record *record;
+
+	close_trace()
+
+DESCRIPTION
+    -trace_clock returns the wall clock in seconds, to time a decision.
+
+    -write_trace writes a record to the file given with -trace, after the
+	header of the file the first time. The layout of the file is in
+	trace.h.
+
+    -close_trace closes the file.
+
+*********************************************************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "cubes.h"
+#include "trace.h"
+#include <string.h>
+#include <time.h>
+
+static int trace_started = 0;	/* the header was written */
+
+/***********************************************************************/
+
+double trace_clock()
+
+{
+  struct timespec now;
+
+  if(clock_gettime(CLOCK_MONOTONIC,&now) != 0) return(0.0);
+  return(now.tv_sec + now.tv_nsec / 1e9);
+}
+
+/***********************************************************************/
+
+write_trace(record)
+
+struct trace_record *record;
+{
+  struct trace_header header;
+
+  if(trace_file == NULL) return;
+  if(trace_started == 0)
+   { memset((char *)&header,0,sizeof(header));
+     memcpy(header.magic,TRACE_MAGIC,sizeof(header.magic));
+     header.version = TRACE_VERSION;
+     header.record_size = sizeof(struct trace_record);
+     if(fwrite((char *)&header,sizeof(header),1,trace_file) != 1)
+	fatal_system_error("unable to write the trace");
+     trace_started = 1;
+   }
+  if(fwrite((char *)record,sizeof(struct trace_record),1,trace_file) != 1)
+	fatal_system_error("unable to write the trace");
+}
+
+/***********************************************************************/
+
+close_trace()
+
+{
+  if(trace_file == NULL) return;
+  fclose(trace_file);
+  trace_file = NULL;
+}
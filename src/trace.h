@@ -0,0 +1,42 @@
+/************************************************************************
+
+NAME
+	trace.h
+
+DESCRIPTION
+	This file contains the layout of the branching trace written by
+	the program with -trace and read by tracesum. The file begins with
+	a trace_header followed by one trace_record for each node selected
+	in a cycle, in the order the decisions are completed. The numbers
+	are written in the representation of the machine running McBOOLE.
+
+*********************************************************************/
+
+#define TRACE_MAGIC "MCBTRACE"	/* first 8 bytes of a trace file */
+#define TRACE_VERSION 1
+
+#define TRACE_BRANCHED 0	/* both solutions were tried */
+#define TRACE_FORCED 1		/* retained without branching, at a limit */
+
+struct trace_header
+ { char magic[8];		/* TRACE_MAGIC */
+   int version;			/* TRACE_VERSION */
+   int record_size;		/* sizeof(struct trace_record) */
+ };
+
+struct trace_record
+ { int kind;			/* TRACE_BRANCHED or TRACE_FORCED */
+   int depth;			/* branching depth of the decision */
+   int partition;		/* undecided nodes in the partition */
+   int node;			/* id of the node selected */
+   int score;			/* score given by select_node */
+   int node_cost;		/* number of literals of the node */
+   int retain_count;		/* cubes of the partition, node retained */
+   int retain_cost;		/* their literals */
+   int unretain_count;		/* cubes of the partition, node unretained */
+   int unretain_cost;		/* their literals */
+   int kept;			/* 1 when the solution with the node
+				   unretained was kept */
+   int spare;			/* unused, 0 */
+   double seconds;		/* wall clock time of the decision */
+ };
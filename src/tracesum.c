@@ -0,0 +1,180 @@
+/*********************************************************************
+
+NAME
+	tracesum
+
+PURPOSE
+	Summarize the branching trace written by McBOOLE with -trace, to
+	see at which depth the covering spends its time and how often the
+	node chosen by select_node was worth branching on.
+
+SYNOPSIS
+	tracesum file
+
+DESCRIPTION
+	For each branching depth one line is printed with the number of
+	decisions branched and forced by a limit, the smallest, mean and
+	largest partition, the mean score of the nodes selected, how many
+	times the solution with the node retained was kept, and the total
+	and largest time of the decisions in seconds.
+
+	A histogram of the partition sizes follows, with one line per
+	power of 2 and one column per depth, and a histogram of the scores
+	of the nodes selected, to compare the scores of the decisions where
+	retaining the node was the better choice with the others.
+
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+#define MAX_DEPTH 64		/* deepest depth summarized */
+#define SIZE_CLASSES 24		/* partition sizes up to 2^23 */
+#define SCORE_CLASSES 12	/* scores up to 2^11 */
+
+struct depth_summary
+ { long branched;		/* decisions with both solutions tried */
+   long forced;			/* decisions at a limit */
+   long smallest;		/* smallest partition */
+   long largest;		/* largest partition */
+   double partitions;		/* sum of the partition sizes */
+   double scores;		/* sum of the scores */
+   long retain_kept;		/* node retained in the solution kept */
+   double seconds;		/* time of the decisions */
+   double longest;		/* longest decision */
+   long size_class[SIZE_CLASSES];	/* partitions by power of 2 */
+ };
+
+static struct depth_summary summary[MAX_DEPTH + 1];
+
+static long
+	score_retained[SCORE_CLASSES],	/* scores when retaining was better */
+	score_unretained[SCORE_CLASSES];	/* scores of the others */
+
+/***********************************************************************/
+
+/* power_class returns the power of 2 class of a number, 0 for 0 or 1 */
+
+static int power_class(value,classes)
+
+long value;
+int classes;
+{
+  int class;
+
+  for(class = 0 ; value > 1 && class < classes - 1 ; class++) value >>= 1;
+  return(class);
+}
+
+/***********************************************************************/
+
+main(argc,argv)
+
+int argc;
+char **argv;
+{
+  FILE *fp;
+
+  struct trace_header header;
+
+  struct trace_record record;
+
+  struct depth_summary *d;
+
+  long total;
+
+  int depth,deepest,class,largest_class,i;
+
+  if(argc != 2)
+   { fprintf(stderr,"usage: tracesum file\n");
+     exit(1);
+   }
+  fp = fopen(argv[1],"r");
+  if(fp == NULL)
+   { perror(argv[1]);
+     exit(1);
+   }
+  if(fread((char *)&header,sizeof(header),1,fp) != 1)
+   { printf("no decision recorded\n");
+     exit(0);
+   }
+  if(memcmp(header.magic,TRACE_MAGIC,sizeof(header.magic)) != 0 ||
+     header.version != TRACE_VERSION ||
+     header.record_size != sizeof(struct trace_record))
+   { fprintf(stderr,"%s: not a trace of this version or machine\n",argv[1]);
+     exit(1);
+   }
+
+  total = 0;
+  deepest = 0;
+  largest_class = 0;
+  while(fread((char *)&record,sizeof(record),1,fp) == 1)
+   { depth = record.depth < MAX_DEPTH ? record.depth : MAX_DEPTH;
+     if(depth < 0) depth = 0;
+     if(depth > deepest) deepest = depth;
+     d = summary + depth;
+     if(d->branched + d->forced == 0 || record.partition < d->smallest)
+	d->smallest = record.partition;
+     if(record.partition > d->largest) d->largest = record.partition;
+     d->partitions += record.partition;
+     d->scores += record.score;
+     class = power_class((long)record.partition,SIZE_CLASSES);
+     d->size_class[class]++;
+     if(class > largest_class) largest_class = class;
+     if(record.kind == TRACE_FORCED) d->forced++;
+     else
+      { d->branched++;
+	d->seconds += record.seconds;
+	if(record.seconds > d->longest) d->longest = record.seconds;
+	class = power_class((long)record.score,SCORE_CLASSES);
+	if(record.kept == 0)
+	 { d->retain_kept++;
+	   score_retained[class]++;
+	 }
+	else score_unretained[class]++;
+      }
+     total++;
+   }
+  fclose(fp);
+  if(total == 0)
+   { printf("no decision recorded\n");
+     exit(0);
+   }
+
+  printf("%ld decisions\n\n",total);
+  printf("depth branched   forced smallest     mean  largest  score");
+  printf(" retained  seconds  longest\n");
+  for(depth = 0 ; depth <= deepest ; depth++)
+   { d = summary + depth;
+     if(d->branched + d->forced == 0) continue;
+     printf("%5d %8ld %8ld %8ld %8.1f %8ld %6.1f %8ld %8.3f %8.3f\n",depth,
+	d->branched,d->forced,d->smallest,
+	d->partitions / (d->branched + d->forced),d->largest,
+	d->scores / (d->branched + d->forced),d->retain_kept,d->seconds,
+	d->longest);
+   }
+
+  printf("\npartition  ");
+  for(depth = 0 ; depth <= deepest ; depth++)
+   { if(summary[depth].branched + summary[depth].forced) printf(" %7d",depth);
+   }
+  printf("\n");
+  for(class = 0 ; class <= largest_class ; class++)
+   { printf("< %-8ld ",1L << (class + 1));
+     for(depth = 0 ; depth <= deepest ; depth++)
+      { d = summary + depth;
+	if(d->branched + d->forced) printf(" %7ld",d->size_class[class]);
+      }
+     printf("\n");
+   }
+
+  printf("\nscore       retained unretained\n");
+  for(i = 0 ; i < SCORE_CLASSES ; i++)
+   { if(score_retained[i] + score_unretained[i] == 0) continue;
+     printf("< %-8ld %8ld %10ld\n",1L << (i + 1),score_retained[i],
+	    score_unretained[i]);
+   }
+  exit(0);
+}
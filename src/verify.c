@@ -1,17 +1,33 @@
 /********************************************************************
 
 NAME
-	This program calls all the functions in cube.c and test each 
-	of them touroughly before any algorithm is to be implemented 
-	using this library.
+	verify
 
 PURPOSE
-	debug completely cubes.c
+	Check that two files describe the same function, for instance a
+	function and the solution given by McBOOLE. A diff of the outputs
+	is not enough, two minimum covers of a function may differ.
+
+SYNOPSIS
+	verify [-i1] file1 [-i2] file2 [-rit c] [-rot c]
+
+DESCRIPTION
+	Each cube of a file is sharped by all the cubes of the other file;
+	what is left of it must only hold don't cares at output. The test
+	is done both ways, so that the don't cares of the function are
+	accepted in the solution. A part of a cube of the first file that
+	is a don't care in another of its cubes needs not be covered by
+	the second file. Only the cube library is used, not the
+	algorithms of the program.
+
+	The exit status is 0 when the functions are equivalent and 1
+	otherwise, so that verify can be used in scripts.
 
 **********************************************************************/
 
 #include "cubes.h"
 #include "param.h"
+#include <stdlib.h>
 
 FILE *input_file1, *input_file2, *output_file;
 
@@ -38,25 +54,22 @@ struct parameter parmv[]
 int parmc = sizeof(parmv) / sizeof(struct parameter);
 
 int
-	input_number,
-	output_number,
-	total_number;
+	VERBOSIS = 0,		/* used by the allocation routines */
+	memory_limit = 0;	/* no memory budget */
 
-char error_buffer[132];
-
-struct node *spare_node;
-	
 main(argc,argv)
 
 int argc;
 char **argv;
 {
-  struct node *list1, *list2, *temp1, *temp2;
+  struct node *list1, *list2, *temp1, *temp2, *dont_care;
 
   struct cube_list *temp_cube, *temp_cube2;
 
   int i, error1, error2;
-  
+
+  error1 = 0;
+  error2 = 0;
   param(parmc,parmv,argc,argv);
 
   i = fread_nodes(input_file1,&list1);
@@ -66,7 +79,21 @@ char **argv;
   i = fread_nodes(input_file2,&list2);
 
   fprintf(stdout,"%d nodes read from the second file\n",i);
-  send_user_dtime(stdout,"both files are read");
+  send_user_dtime("both files are read");
+
+/* a part of a cube of the first file may be a dont care in another cube,
+   the solution does not need to cover it. The dont care part of the
+   cubes is kept with the dont care changed to 1.			*/
+
+  dont_care = NULL;
+  for(temp1 = list1 ; temp1 != 0 ; temp1 = temp1->next_node)
+   { if(detect_dont_care(temp1->cube) == 0) continue;
+     temp2 = copy_and_alloc_node(temp1->cube);
+     remove_do_care(temp2->cube);
+     change_dont_to_do_care(temp2->cube);
+     temp2->next_node = dont_care;
+     dont_care = temp2;
+   }
 
   temp1 = list1;
   for(; temp1 != 0 ; temp1 = temp1->next_node)
@@ -75,6 +102,11 @@ char **argv;
      for(; temp2 != 0 ; temp2 = temp2->next_node)
       { if(disjoint_sharp(&temp_cube,temp2->cube) < 0) break;
       }
+     if(temp2 == 0)
+      { for(temp2 = dont_care ; temp2 != 0 ; temp2 = temp2->next_node)
+	 { if(disjoint_sharp(&temp_cube,temp2->cube) < 0) break;
+	 }
+      }
      if(temp2 == 0)
       { temp_cube2 = temp_cube;
 	for(; temp_cube2 != 0 ; temp_cube2 = temp_cube2->next_cube)
@@ -127,6 +159,7 @@ char **argv;
   if(error1 == 0 && error2 == 0)
    { fprintf(stdout,"Both files describe strictly equivalent functions\n");
    }
-  send_user_dtime(stdout,"the covering was verified");
+  send_user_dtime("the covering was verified");
+  exit(error1 || error2 ? 1 : 0);
 }
 
@@ -0,0 +1,825 @@
+/*********************************************************************
+
+NAME
+	prime_implicants_by_zdd, zdd_cleanup
+
+PURPOSE
+	Generate the prime implicants of a boolean function implicitly,
+	as a zero-suppressed decision diagram, instead of building them
+	one star product at a time in the partition tree. When a function
+	has a very large number of prime implicants, the partition tree and
+	the links between all the intermediate nodes exhaust the memory long
+	before the covering starts; the implicit set of primes stays small
+	and only the prime implicants a cover may need, the essential ones
+	and those covering a part left by them, are placed in the graph.
+
+SYNOPSIS
+	struct node *prime_implicants_by_zdd(list)
+	struct node *list;
+
+	zdd_cleanup()
+
+DESCRIPTION
+	A multiple output function f1..fm of the inputs x is represented by
+	the single output function H(x,y) = AND over i of (fi(x) OR NOT yi),
+	where fi includes the dont care part of output i. An implicant of H
+	with the negative literals NOT yj for the outputs j not in O is
+	exactly a multiple output implicant with output part O, and the
+	prime implicants of H are the multiple output prime implicants, plus
+	the trivial one with all the outputs at 0 which is dropped.
+
+	H is built as a BDD from the list of cubes received, with the inputs
+	above the outputs in the variable order. Its prime implicants are
+	then computed with the recursive formula of Coudert and Madre:
+
+	P(f) = P(f0.f1) + NOT v.(P(f0) - P(f0.f1)) + v.(P(f1) - P(f0.f1))
+
+	where the sets of cubes are kept in a ZDD having two variables for
+	each variable of the BDD, one for the positive and one for the
+	negative literal.
+
+	Only the prime implicants a cover may need are materialized, in
+	three walks of the ZDD. The first builds, for each output, the
+	points of its care part covered by at least one and by at least
+	two prime implicants. The second places in the graph the essential
+	prime implicants, those having a care point covered by no other.
+	The third places the prime implicants intersecting the care part
+	left uncovered by the essential ones; the others, in the dont care
+	part or under the essential ones only, can be removed from any
+	cover. The dont care cover is placed in separate DONT_CARE nodes,
+	as the recursive partitioning does, and the nodes are linked
+	together by link_prime_list.
+
+	The list received is consumed; the list returned contains the dont
+	care nodes followed by the prime implicants. The tables are freed
+	by zdd_cleanup, which generate_prime_implicants also calls when
+	the memory budget stops the engine.
+
+*********************************************************************/
+
+#include "cubes.h"
+#include <stdlib.h>
+
+#define DD_ZERO 0		/* false for a BDD, empty set for a ZDD */
+#define DD_ONE 1		/* true for a BDD, set of the empty cube */
+#define DD_TERMINAL_VAR 0x7fffffff	/* variable of the terminal nodes */
+#define DD_INITIAL_SIZE 4096	/* initial number of nodes in a table */
+#define DD_CACHE_SIZE 262144	/* entries in the computed table, 2^n */
+
+#define OP_AND 1
+#define OP_OR 2
+#define OP_DIFF 3
+#define OP_PRIMES 4
+#define OP_NOT 5
+
+#define WALK_COUNT 0		/* count the primes covering each point */
+#define WALK_ESSENTIAL 1	/* materialize the essential primes */
+#define WALK_REMAINING 2	/* materialize the primes still needed */
+
+struct dd_node
+ { int var;			/* variable, smaller is closer to the root */
+   int lo;			/* index of the node for var at 0 */
+   int hi;			/* index of the node for var at 1 */
+   int next;			/* next node in the same hash bucket */
+ };
+
+struct dd_table
+ { struct dd_node *nodes;	/* all the nodes, terminals at 0 and 1 */
+   int count;			/* number of nodes used */
+   int size;			/* number of nodes allocated */
+   int *bucket;			/* first node of each hash bucket */
+ };
+
+struct dd_cache
+ { int op;			/* operation, 0 when the entry is empty */
+   int a;			/* first operand */
+   int b;			/* second operand */
+   int result;			/* result of the operation */
+ };
+
+static struct dd_table
+	bdd,			/* nodes of the functions */
+	zdd;			/* nodes of the sets of cubes */
+
+static struct dd_cache *dd_cache;	/* results already computed */
+
+static long dd_peak_bytes;	/* biggest memory used by the tables */
+
+static int
+	*walk_stamp,		/* last query that visited each bdd node */
+	*walk_value,		/* result of the visit for that query */
+	walk_query;		/* number of the current query */
+
+static struct node *zdd_prime_list;	/* prime implicants materialized */
+
+static int
+	*on_output,		/* function of each output, with dont care */
+	*dc_output,		/* dont care function of each output */
+	*care_output,		/* care function of each output */
+	*zdd_lits,		/* literals on a path of the ZDD */
+	*once_output,		/* points of an output covered by a prime */
+	*twice_output,		/* points covered by two primes or more */
+	unique_function,	/* care points covered by one prime only */
+	remaining_function,	/* care points not covered by the essentials */
+	zdd_walk,		/* what the walk of the primes does */
+	zdd_prime_kept,		/* number of primes placed in the list */
+	zdd_prime_essential,	/* essential primes in the list */
+	zdd_prime_dropped;	/* primes not needed by the cover */
+
+/***********************************************************************/
+
+static dd_init_table(table)
+
+struct dd_table *table;
+{
+  int i;
+
+  table->size = DD_INITIAL_SIZE;
+  table->nodes = (struct dd_node *)
+	calloc((unsigned)table->size,sizeof(struct dd_node));
+  table->bucket = (int *)calloc((unsigned)table->size,sizeof(int));
+  if(table->nodes == NULL || table->bucket == NULL)
+	fatal_system_error("unable to alloc decision diagram");
+  for(i = 0 ; i < table->size ; i++) table->bucket[i] = -1;
+  for(i = DD_ZERO ; i <= DD_ONE ; i++)
+   { table->nodes[i].var = DD_TERMINAL_VAR;
+     table->nodes[i].lo = i;
+     table->nodes[i].hi = i;
+     table->nodes[i].next = -1;
+   }
+  table->count = 2;
+}
+
+/***********************************************************************/
+
+static int dd_hash(var,lo,hi,size)
+
+int var,lo,hi,size;
+{
+  unsigned long key;
+
+  key = (unsigned long)var * 12582917UL;
+  key = (key ^ (unsigned long)lo) * 4256249UL;
+  key = (key ^ (unsigned long)hi) * 741457UL;
+  return((int)((key >> 7) & (unsigned long)(size - 1)));
+}
+
+/***********************************************************************/
+
+static long dd_memory()
+
+{
+  return((long)(bdd.size + zdd.size) * (sizeof(struct dd_node) + sizeof(int))
+	 + (long)DD_CACHE_SIZE * sizeof(struct dd_cache));
+}
+
+/***********************************************************************/
+
+/* dd_find returns the node (var,lo,hi) of the table, creating it if it
+   does not exist. The reduction rule is applied by the caller.	*/
+
+static int dd_find(table,var,lo,hi)
+
+struct dd_table *table;
+int var,lo,hi;
+{
+  struct dd_node *temp;		/* node examined */
+
+  int
+	i,			/* index of the node */
+	h;			/* hash bucket */
+
+  h = dd_hash(var,lo,hi,table->size);
+  for(i = table->bucket[h] ; i >= 0 ; i = temp->next)
+   { temp = table->nodes + i;
+     if(temp->var == var && temp->lo == lo && temp->hi == hi) return(i);
+   }
+
+/* the node does not exist, when the table is full it is doubled and all
+   the nodes are placed again in the new buckets.			*/
+
+  PROGRESS();
+  if(table->count == table->size)
+   { table->size *= 2;
+     table->nodes = (struct dd_node *)realloc((char *)table->nodes,
+		(unsigned)table->size * sizeof(struct dd_node));
+     free((char *)table->bucket);
+     table->bucket = (int *)calloc((unsigned)table->size,sizeof(int));
+     if(table->nodes == NULL || table->bucket == NULL)
+	fatal_system_error("unable to alloc decision diagram");
+     for(i = 0 ; i < table->size ; i++) table->bucket[i] = -1;
+     for(i = 2 ; i < table->count ; i++)
+      { temp = table->nodes + i;
+	h = dd_hash(temp->var,temp->lo,temp->hi,table->size);
+	temp->next = table->bucket[h];
+	table->bucket[h] = i;
+      }
+     if(dd_memory() > dd_peak_bytes) dd_peak_bytes = dd_memory();
+     charge_memory((long)(table->size / 2) *
+		   (sizeof(struct dd_node) + sizeof(int)));
+     h = dd_hash(var,lo,hi,table->size);
+   }
+
+  i = table->count++;
+  temp = table->nodes + i;
+  temp->var = var;
+  temp->lo = lo;
+  temp->hi = hi;
+  temp->next = table->bucket[h];
+  table->bucket[h] = i;
+  return(i);
+}
+
+/***********************************************************************/
+
+static int bdd_node(var,lo,hi)
+
+int var,lo,hi;
+{
+  if(lo == hi) return(lo);
+  return(dd_find(&bdd,var,lo,hi));
+}
+
+/***********************************************************************/
+
+static int zdd_node(var,lo,hi)
+
+int var,lo,hi;
+{
+  if(hi == DD_ZERO) return(lo);
+  return(dd_find(&zdd,var,lo,hi));
+}
+
+/***********************************************************************/
+
+static struct dd_cache *dd_lookup(op,a,b)
+
+int op,a,b;
+{
+  unsigned long key;
+
+  key = ((unsigned long)op * 31UL + (unsigned long)a) * 1000003UL
+	+ (unsigned long)b;
+  key = (key ^ (key >> 15)) & (DD_CACHE_SIZE - 1);
+  return(dd_cache + key);
+}
+
+/***********************************************************************/
+
+/* bdd_apply returns the AND or the OR of two functions */
+
+static int bdd_apply(op,a,b)
+
+int op,a,b;
+{
+  struct dd_cache *entry;	/* entry in the computed table */
+
+  int
+	var,			/* top variable of a and b */
+	a0,a1,b0,b1,		/* cofactors of a and b */
+	lo,hi,temp;
+
+  if(op == OP_AND)
+   { if(a == DD_ZERO || b == DD_ZERO) return(DD_ZERO);
+     if(a == DD_ONE) return(b);
+     if(b == DD_ONE || a == b) return(a);
+   }
+  else
+   { if(a == DD_ONE || b == DD_ONE) return(DD_ONE);
+     if(a == DD_ZERO) return(b);
+     if(b == DD_ZERO || a == b) return(a);
+   }
+  if(a > b)
+   { temp = a;
+     a = b;
+     b = temp;
+   }
+
+  entry = dd_lookup(op,a,b);
+  if(entry->op == op && entry->a == a && entry->b == b) return(entry->result);
+
+  var = bdd.nodes[a].var;
+  if(bdd.nodes[b].var < var) var = bdd.nodes[b].var;
+  if(bdd.nodes[a].var == var)
+   { a0 = bdd.nodes[a].lo;
+     a1 = bdd.nodes[a].hi;
+   }
+  else a0 = a1 = a;
+  if(bdd.nodes[b].var == var)
+   { b0 = bdd.nodes[b].lo;
+     b1 = bdd.nodes[b].hi;
+   }
+  else b0 = b1 = b;
+
+  lo = bdd_apply(op,a0,b0);
+  hi = bdd_apply(op,a1,b1);
+  temp = bdd_node(var,lo,hi);
+
+  entry = dd_lookup(op,a,b);
+  entry->op = op;
+  entry->a = a;
+  entry->b = b;
+  entry->result = temp;
+  return(temp);
+}
+
+/***********************************************************************/
+
+/* bdd_not returns the complement of a function */
+
+static int bdd_not(a)
+
+int a;
+{
+  struct dd_cache *entry;	/* entry in the computed table */
+
+  int lo,hi,result;
+
+  if(a == DD_ZERO) return(DD_ONE);
+  if(a == DD_ONE) return(DD_ZERO);
+
+  entry = dd_lookup(OP_NOT,a,0);
+  if(entry->op == OP_NOT && entry->a == a) return(entry->result);
+
+  lo = bdd_not(bdd.nodes[a].lo);
+  hi = bdd_not(bdd.nodes[a].hi);
+  result = bdd_node(bdd.nodes[a].var,lo,hi);
+
+  entry = dd_lookup(OP_NOT,a,0);
+  entry->op = OP_NOT;
+  entry->a = a;
+  entry->b = 0;
+  entry->result = result;
+  return(result);
+}
+
+/***********************************************************************/
+
+/* zdd_diff returns the cubes of a which are not in b */
+
+static int zdd_diff(a,b)
+
+int a,b;
+{
+  struct dd_cache *entry;	/* entry in the computed table */
+
+  int var_a,var_b,lo,hi,result;
+
+  if(a == DD_ZERO || a == b) return(DD_ZERO);
+  if(b == DD_ZERO) return(a);
+
+  entry = dd_lookup(OP_DIFF,a,b);
+  if(entry->op == OP_DIFF && entry->a == a && entry->b == b)
+	return(entry->result);
+
+  var_a = zdd.nodes[a].var;
+  var_b = zdd.nodes[b].var;
+  if(var_a < var_b)
+   { lo = zdd_diff(zdd.nodes[a].lo,b);
+     result = zdd_node(var_a,lo,zdd.nodes[a].hi);
+   }
+  else if(var_a > var_b) result = zdd_diff(a,zdd.nodes[b].lo);
+  else
+   { lo = zdd_diff(zdd.nodes[a].lo,zdd.nodes[b].lo);
+     hi = zdd_diff(zdd.nodes[a].hi,zdd.nodes[b].hi);
+     result = zdd_node(var_a,lo,hi);
+   }
+
+  entry = dd_lookup(OP_DIFF,a,b);
+  entry->op = OP_DIFF;
+  entry->a = a;
+  entry->b = b;
+  entry->result = result;
+  return(result);
+}
+
+/***********************************************************************/
+
+/* zdd_primes returns the set of prime implicants of the function f, the
+   literal v of the BDD is the variable 2v in the ZDD and NOT v is 2v+1 */
+
+static int zdd_primes(f)
+
+int f;
+{
+  struct dd_cache *entry;	/* entry in the computed table */
+
+  int var,f0,f1,p01,p0,p1,result;
+
+  if(f == DD_ZERO) return(DD_ZERO);
+  if(f == DD_ONE) return(DD_ONE);
+
+  entry = dd_lookup(OP_PRIMES,f,0);
+  if(entry->op == OP_PRIMES && entry->a == f) return(entry->result);
+
+  var = bdd.nodes[f].var;
+  f0 = bdd.nodes[f].lo;
+  f1 = bdd.nodes[f].hi;
+  p01 = zdd_primes(bdd_apply(OP_AND,f0,f1));
+  p0 = zdd_diff(zdd_primes(f0),p01);
+  p1 = zdd_diff(zdd_primes(f1),p01);
+  result = zdd_node(2 * var,zdd_node(2 * var + 1,p01,p0),p1);
+
+  entry = dd_lookup(OP_PRIMES,f,0);
+  entry->op = OP_PRIMES;
+  entry->a = f;
+  entry->b = 0;
+  entry->result = result;
+  return(result);
+}
+
+/***********************************************************************/
+
+/* bdd_of_cube returns the function of the input part of a cube */
+
+static int bdd_of_cube(cube)
+
+long int *cube;
+{
+  int var,result;
+
+  result = DD_ONE;
+  for(var = input_number - 1 ; var >= 0 ; var--)
+   { switch(extract_var(cube,var))
+      { case _1_ :
+	  result = bdd_node(var,DD_ZERO,result);
+	  break;
+	case _0_ :
+	  result = bdd_node(var,result,DD_ZERO);
+	  break;
+      }
+   }
+  return(result);
+}
+
+/***********************************************************************/
+
+/* care_walk tells if some point of the function f, restricted to the
+   input part of cube and with the outputs of cube at 1 and the others
+   at 0, is true. Each bdd node is evaluated once for a given query.   */
+
+static int care_walk(f,cube)
+
+int f;
+long int *cube;
+{
+  int var,result;
+
+  if(f == DD_ZERO) return(0);
+  if(f == DD_ONE) return(1);
+  if(walk_stamp[f] == walk_query) return(walk_value[f]);
+
+  var = bdd.nodes[f].var;
+  if(var < input_number)
+   { switch(extract_var(cube,var))
+      { case _1_ :
+	  result = care_walk(bdd.nodes[f].hi,cube);
+	  break;
+	case _0_ :
+	  result = care_walk(bdd.nodes[f].lo,cube);
+	  break;
+	default :
+	  result = care_walk(bdd.nodes[f].lo,cube) ||
+		   care_walk(bdd.nodes[f].hi,cube);
+	  break;
+      }
+   }
+  else
+   { var = var - input_number + input_length * var_per_word;
+     if(extract_var(cube,var) & _1_) result = care_walk(bdd.nodes[f].hi,cube);
+     else result = care_walk(bdd.nodes[f].lo,cube);
+   }
+
+  walk_stamp[f] = walk_query;
+  walk_value[f] = result;
+  return(result);
+}
+
+/***********************************************************************/
+
+/* count_cover adds the cube to the points of its outputs covered once
+   and twice.								*/
+
+static count_cover(cube)
+
+long int *cube;
+{
+  int row,i;
+
+  row = bdd_of_cube(cube);
+  for(i = 0 ; i < output_number ; i++)
+   { if((extract_var(cube,input_length * var_per_word + i) & _1_) == 0)
+	continue;
+     twice_output[i] = bdd_apply(OP_OR,twice_output[i],
+			bdd_apply(OP_AND,once_output[i],row));
+     once_output[i] = bdd_apply(OP_OR,once_output[i],row);
+   }
+}
+
+/***********************************************************************/
+
+/* zdd_enumerate walks all the cubes of the set z, doing for each what
+   zdd_walk tells; the literals on the path from the root are in lits. */
+
+static zdd_enumerate(z,lits,depth)
+
+int z,*lits,depth;
+{
+  long int *cube;		/* cube built for the path */
+
+  struct node *next_spare;	/* spare node for the next cube */
+
+  int i,var,empty;
+
+  if(z == DD_ZERO) return;
+  if(z != DD_ONE)
+   { zdd_enumerate(zdd.nodes[z].lo,lits,depth);
+     lits[depth] = zdd.nodes[z].var;
+     zdd_enumerate(zdd.nodes[z].hi,lits,depth + 1);
+     return;
+   }
+
+/* a prime implicant is reached, we build its cube: all the inputs are x
+   and all the outputs are 1 except for the literals on the path.     */
+
+  cube = spare_node->cube;
+  for(i = 0 ; i < input_length ; i++) cube[i] = mask11;
+  for(; i < total_length ; i++) cube[i] = mask00;
+  for(i = 0 ; i < output_number ; i++)
+   { define_current_var(input_length * var_per_word + i);
+     set_current_var(cube,mask01);
+   }
+  for(i = 0 ; i < depth ; i++)
+   { var = lits[i] >> 1;
+     if(var < input_number)
+      { define_current_var(var);
+	set_current_var(cube,(lits[i] & 1) ? mask10 : mask01);
+      }
+     else
+      { define_current_var(var - input_number + input_length * var_per_word);
+	set_current_var(cube,mask00);
+      }
+   }
+
+  empty = empty_output(cube);
+  if(empty) return;
+
+/* the primes are counted, then the essential ones are kept, then those
+   covering a care point left by the essential ones.		     */
+
+  switch(zdd_walk)
+   { case WALK_COUNT :
+	count_cover(cube);
+	return;
+
+     case WALK_ESSENTIAL :
+	walk_query++;
+	if(care_walk(unique_function,cube) == 0) return;
+	zdd_prime_essential++;
+	break;
+
+     default :
+	walk_query++;
+	if(care_walk(unique_function,cube)) return;
+	walk_query++;
+	if(care_walk(remaining_function,cube) == 0)
+	 { zdd_prime_dropped++;
+	   return;
+	 }
+	break;
+   }
+
+/* the next spare node is allocated first, so that spare_node is not in
+   the list when the memory budget stops the walk.			*/
+
+  next_spare = alloc_node();
+  spare_node->next_node = zdd_prime_list;
+  spare_node->status = BASIC;
+  zdd_prime_list = spare_node;
+  zdd_prime_kept++;
+  spare_node = next_spare;
+}
+
+/***********************************************************************/
+
+/* output_union returns the OR over the outputs i of the function of
+   output i AND NOT the function excluded of output i AND yi.	      */
+
+static int output_union(output,excluded)
+
+int *output,*excluded;
+{
+  int result,i;
+
+  result = DD_ZERO;
+  for(i = output_number - 1 ; i >= 0 ; i--)
+   { result = bdd_apply(OP_OR,result,bdd_apply(OP_AND,
+		bdd_apply(OP_AND,output[i],bdd_not(excluded[i])),
+		bdd_node(input_number + i,DD_ZERO,DD_ONE)));
+   }
+  return(result);
+}
+
+/***********************************************************************/
+
+/* walk_primes walks the set of primes with a new walk_stamp vector, as
+   the BDD grew since the last walk.					*/
+
+static walk_primes(primes,lits,walk)
+
+int primes,*lits,walk;
+{
+  if(walk_stamp != NULL) free((char *)walk_stamp);
+  if(walk_value != NULL) free((char *)walk_value);
+  walk_stamp = (int *)calloc((unsigned)bdd.count,sizeof(int));
+  walk_value = (int *)calloc((unsigned)bdd.count,sizeof(int));
+  if(walk_stamp == NULL || walk_value == NULL)
+	fatal_system_error("unable to alloc decision diagram");
+  walk_query = 0;
+  zdd_walk = walk;
+  zdd_enumerate(primes,lits,0);
+}
+
+/***********************************************************************/
+
+/* zdd_count returns the number of cubes in the set z */
+
+static double zdd_count(z,memo)
+
+int z;
+double *memo;
+{
+  if(z == DD_ZERO) return(0.0);
+  if(z == DD_ONE) return(1.0);
+  if(memo[z] < 0.0)
+	memo[z] = zdd_count(zdd.nodes[z].lo,memo) +
+		  zdd_count(zdd.nodes[z].hi,memo);
+  return(memo[z]);
+}
+
+/***********************************************************************/
+
+struct node
+*prime_implicants_by_zdd(list)
+
+struct node *list;
+{
+  struct node
+	*temp_node,	/* node in the list */
+	*next_node,	/* next node in the list */
+	*dont_care;	/* nodes of the dont care cover */
+
+  int
+	row,		/* function of the input part of a cube */
+	function,	/* the function H */
+	primes,		/* the set of prime implicants of H */
+	i,code;
+
+  double *memo;		/* number of cubes below each ZDD node */
+
+  if(DISJOINT_REQUIRED) check_disjoint_input(list);
+
+  walk_stamp = NULL;
+  walk_value = NULL;
+  zdd_prime_list = NULL;
+  dd_init_table(&bdd);
+  dd_init_table(&zdd);
+  dd_cache = (struct dd_cache *)
+		calloc((unsigned)DD_CACHE_SIZE,sizeof(struct dd_cache));
+  on_output = (int *)calloc((unsigned)output_number,sizeof(int));
+  dc_output = (int *)calloc((unsigned)output_number,sizeof(int));
+  care_output = (int *)calloc((unsigned)output_number,sizeof(int));
+  once_output = (int *)calloc((unsigned)output_number,sizeof(int));
+  twice_output = (int *)calloc((unsigned)output_number,sizeof(int));
+  if(dd_cache == NULL || on_output == NULL || dc_output == NULL ||
+     care_output == NULL || once_output == NULL || twice_output == NULL)
+	fatal_system_error("unable to alloc decision diagram");
+  dd_peak_bytes = dd_memory();
+  charge_memory(dd_memory());
+
+/* Each cube is added to the function of the outputs where it has a 1 or
+   a dont care, and to the dont care function of the outputs where it
+   has a dont care; its dont care part is kept as a dont care node.    */
+
+  dont_care = NULL;
+  for(temp_node = list ; temp_node != NULL ; temp_node = next_node)
+   { next_node = temp_node->next_node;
+     if(empty_output(temp_node->cube) == 0)
+      { row = bdd_of_cube(temp_node->cube);
+	for(i = 0 ; i < output_number ; i++)
+	 { code = extract_var(temp_node->cube,input_length * var_per_word + i);
+	   if(code & _1_) on_output[i] = bdd_apply(OP_OR,on_output[i],row);
+	   if(code == _X_) dc_output[i] = bdd_apply(OP_OR,dc_output[i],row);
+	 }
+
+	if(detect_dont_care(temp_node->cube))
+	 { temp_node->next_node = dont_care;
+	   dont_care = temp_node;
+	   remove_do_care(temp_node->cube);
+	   temp_node->status = DONT_CARE;
+	   continue;
+	 }
+      }
+     free_node(temp_node);
+   }
+
+/* where a 1 and a dont care overlap, the dont care is the strongest as
+   in the recursive partitioning. The care function of an output is true
+   where it is on without being a dont care.				*/
+
+  for(i = 0 ; i < output_number ; i++)
+	care_output[i] = bdd_apply(OP_AND,on_output[i],bdd_not(dc_output[i]));
+
+  function = DD_ONE;
+  for(i = output_number - 1 ; i >= 0 ; i--)
+   { function = bdd_apply(OP_AND,function,
+	bdd_apply(OP_OR,bdd_node(input_number + i,DD_ONE,DD_ZERO),on_output[i]));
+   }
+
+/* the implicit set of prime implicants is computed. The points covered
+   by one prime only give the essential primes, which are materialized;
+   the other primes are materialized when they cover a care point left
+   by the essential ones.						*/
+
+  primes = zdd_primes(function);
+
+  zdd_lits = (int *)calloc((unsigned)(2 * total_number + 1),sizeof(int));
+  if(zdd_lits == NULL) fatal_system_error("unable to alloc decision diagram");
+  zdd_prime_kept = 0;
+  zdd_prime_essential = 0;
+  zdd_prime_dropped = 0;
+
+  for(i = 0 ; i < output_number ; i++)
+	once_output[i] = twice_output[i] = DD_ZERO;
+  walk_primes(primes,zdd_lits,WALK_COUNT);
+  unique_function = output_union(care_output,twice_output);
+  walk_primes(primes,zdd_lits,WALK_ESSENTIAL);
+
+  for(i = 0 ; i < output_number ; i++) once_output[i] = DD_ZERO;
+  for(temp_node = zdd_prime_list ; temp_node != NULL ;
+      temp_node = temp_node->next_node)
+   { row = bdd_of_cube(temp_node->cube);
+     for(i = 0 ; i < output_number ; i++)
+      { if(extract_var(temp_node->cube,input_length * var_per_word + i) & _1_)
+	    once_output[i] = bdd_apply(OP_OR,once_output[i],row);
+      }
+   }
+  remaining_function = output_union(care_output,once_output);
+  walk_primes(primes,zdd_lits,WALK_REMAINING);
+
+  memo = (double *)calloc((unsigned)zdd.count,sizeof(double));
+  if(memo == NULL) fatal_system_error("unable to alloc decision diagram");
+
+  if(VERBOSIS)
+   { for(i = 0 ; i < zdd.count ; i++) memo[i] = -1.0;
+     sprintf(error_buffer,
+	"zdd engine : %d bdd nodes, %d zdd nodes, %.0f primes, %d kept",
+	bdd.count,zdd.count,zdd_count(primes,memo) - 1.0,zdd_prime_kept);
+     send_user_message(error_buffer);
+     sprintf(error_buffer,
+     "zdd engine : %d essential, %d primes not needed, %ld kbytes peak",
+	zdd_prime_essential,zdd_prime_dropped,dd_peak_bytes / 1024);
+     send_user_message(error_buffer);
+   }
+
+  free((char *)memo);
+  list = merge_node_lists(dont_care,zdd_prime_list);
+  zdd_prime_list = NULL;
+  zdd_cleanup();
+  link_prime_list(list);
+  return(list);
+}
+
+/***********************************************************************/
+
+/* zdd_cleanup frees the tables and the vectors of the engine and releases
+   the memory charged for them, at the end of prime_implicants_by_zdd or
+   when the memory budget stopped it; the prime implicants materialized
+   are freed in the second case.					*/
+
+zdd_cleanup()
+
+{
+  if(bdd.nodes == NULL) return;
+  release_memory(dd_memory());
+  free_list_of_nodes(&zdd_prime_list);
+  free((char *)zdd_lits);
+  free((char *)walk_stamp);
+  free((char *)walk_value);
+  free((char *)on_output);
+  free((char *)dc_output);
+  free((char *)care_output);
+  free((char *)once_output);
+  free((char *)twice_output);
+  free((char *)dd_cache);
+  free((char *)bdd.nodes);
+  free((char *)bdd.bucket);
+  free((char *)zdd.nodes);
+  free((char *)zdd.bucket);
+  zdd_lits = walk_stamp = walk_value = NULL;
+  on_output = dc_output = care_output = once_output = twice_output = NULL;
+  dd_cache = NULL;
+  bdd.nodes = zdd.nodes = NULL;
+  bdd.bucket = zdd.bucket = NULL;
+  bdd.size = zdd.size = 0;
+}